@@ -4,8 +4,37 @@
 #ifndef _API_H_
 #define _API_H_
 
+#include <stddef.h>
+
 #include "sparrow_param.h"
-#include "sparrow_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//  === Global namespace prefix
+#ifdef SPARROW_
+#define crypto_sign_keypair SPARROW_(crypto_sign_keypair)
+#define crypto_encaps       SPARROW_(crypto_encaps)
+#define crypto_decaps       SPARROW_(crypto_decaps)
+#define crypto_sign_keypair_ws  SPARROW_(crypto_sign_keypair_ws)
+#define crypto_encaps_ws        SPARROW_(crypto_encaps_ws)
+#define crypto_decaps_ws        SPARROW_(crypto_decaps_ws)
+#define crypto_decaps_batch     SPARROW_(crypto_decaps_batch)
+#define crypto_decaps_batch_ws  SPARROW_(crypto_decaps_batch_ws)
+#define crypto_prepare_pk       SPARROW_(crypto_prepare_pk)
+#define crypto_encaps_pkp       SPARROW_(crypto_encaps_pkp)
+#define crypto_decaps_pkp       SPARROW_(crypto_decaps_pkp)
+#define crypto_encaps_pkp_ws    SPARROW_(crypto_encaps_pkp_ws)
+#define crypto_decaps_pkp_ws    SPARROW_(crypto_decaps_pkp_ws)
+#endif
+
+//  === Exported symbols (the library is built with -fvisibility=hidden)
+#if defined(__GNUC__) || defined(__clang__)
+#define SPARROW_API __attribute__((visibility("default")))
+#else
+#define SPARROW_API
+#endif
 
 //  Set these three values apropriately for your algorithm
 #define CRYPTO_SECRETKEYBYTES   SPARROW_SK_SZ
@@ -13,16 +42,86 @@
 #define CRYPTO_BYTES            SPARROW_CT_SZ
 #define CRYPTO_SHAREDKEY        SPARROW_K_SZ
 
+//  Working memory of the *_ws functions and their maximum stack use
+#define CRYPTO_WORKSPACEBYTES   SPARROW_WS_SZ
+#define CRYPTO_STACKBYTES       SPARROW_WS_STACK
+#define CRYPTO_BATCH_WORKSPACEBYTES SPARROW_BATCH_WS_SZ
+
+//  Size of a prepared public key
+#define CRYPTO_PREPAREDPKBYTES  SPARROW_PKP_SZ
+
 
 // Change the algorithm name
 #define CRYPTO_ALGNAME          SPARROW_NAME
 
-int
+SPARROW_API int
 crypto_sign_keypair(unsigned char *pk, unsigned char *sk, int transpose);
 
-int crypto_encaps(unsigned char *K, unsigned char *ct, const unsigned char *pkA, const unsigned char *skB);
+SPARROW_API int
+crypto_encaps(unsigned char *K, unsigned char *ct, const unsigned char *pkA, const unsigned char *skB);
+
+SPARROW_API int
+crypto_decaps(unsigned char *K, const unsigned char *ct, const unsigned char *pkB, const unsigned char *skA);
+
+//  The same with caller-provided working memory "ws" of
+//  CRYPTO_WORKSPACEBYTES bytes, 8-byte aligned (e.g. from malloc()), so
+//  that at most CRYPTO_STACKBYTES of stack is used. The functions above
+//  keep that workspace on the stack. Return -1 if "ws" is misaligned.
+
+SPARROW_API int
+crypto_sign_keypair_ws(unsigned char *pk, unsigned char *sk, int transpose,
+                       void *ws);
 
-int crypto_decaps(unsigned char *K, const unsigned char *ct, const unsigned char *pkB, const unsigned char *skA);
+SPARROW_API int
+crypto_encaps_ws(unsigned char *K, unsigned char *ct, const unsigned char *pkA, const unsigned char *skB,
+                 void *ws);
+
+SPARROW_API int
+crypto_decaps_ws(unsigned char *K, const unsigned char *ct, const unsigned char *pkB, const unsigned char *skA,
+                 void *ws);
+
+//  Decapsulate "n" ciphertexts to the same secret key "skA": ciphertext i
+//  at ct + i * CRYPTO_BYTES from the sender with public key pkB + i *
+//  CRYPTO_PUBLICKEYBYTES gives key K + i * CRYPTO_SHAREDKEY. The secret key
+//  is decoded once and the noise of all n comes from one seeded stream.
+//  Rejection is implicit, as in crypto_decaps(). Returns 0, or -1 if a
+//  key does not decode (then all n keys are zeroed) or n > INT_MAX. The _ws form takes
+//  CRYPTO_BATCH_WORKSPACEBYTES of working memory, 8-byte aligned.
+
+SPARROW_API int
+crypto_decaps_batch(unsigned char *K, const unsigned char *ct, const unsigned char *pkB, const unsigned char *skA,
+                    size_t n);
+
+SPARROW_API int
+crypto_decaps_batch_ws(unsigned char *K, const unsigned char *ct, const unsigned char *pkB, const unsigned char *skA,
+                       size_t n, void *ws);
+
+//  Decode public key "pk" once, with its hash tr, into "pkp" of
+//  CRYPTO_PREPAREDPKBYTES bytes, 8-byte aligned; the _pkp functions take
+//  it in place of the encoded key for repeated operations with the same
+//  peer. Returns -1 if "pk" does not decode or "pkp" is misaligned. The
+//  _ws forms take CRYPTO_WORKSPACEBYTES of working memory as above.
+
+SPARROW_API int
+crypto_prepare_pk(void *pkp, const unsigned char *pk);
+
+SPARROW_API int
+crypto_encaps_pkp(unsigned char *K, unsigned char *ct, const void *pkpA, const unsigned char *skB);
+
+SPARROW_API int
+crypto_decaps_pkp(unsigned char *K, const unsigned char *ct, const void *pkpB, const unsigned char *skA);
+
+SPARROW_API int
+crypto_encaps_pkp_ws(unsigned char *K, unsigned char *ct, const void *pkpA, const unsigned char *skB,
+                     void *ws);
+
+SPARROW_API int
+crypto_decaps_pkp_ws(unsigned char *K, const unsigned char *ct, const void *pkpB, const unsigned char *skA,
+                     void *ws);
+
+#ifdef __cplusplus
+}
+#endif
 
 /* _API_H_ */
 #endif
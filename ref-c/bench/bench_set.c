@@ -0,0 +1,80 @@
+//  bench_set.c
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === The output stage of encaps and decaps of one parameter set, fused
+//      and as separate passes: with SPARROW_CTBITS < SPARROW_N the fused
+//      stage computes only the reconciled half of the last inverse NTT
+//      layer. Compiled per set, linked into xbench only.
+
+#include <string.h>
+
+#include "sparrow_core.h"
+#include "sparrow_rec.h"
+#include "polyr.h"
+#include "gauss_sample.h"
+#include "bench_set.h"
+
+//  === Global namespace prefix
+#ifdef SPARROW_
+#define bench_set SPARROW_(bench_set)
+#endif
+
+static struct {
+    int64_t v[SPARROW_N], r[SPARROW_N], y[SPARROW_N];
+    uint64_t rnd[REC_RAND_WORDS];
+    racc_ciphertext_t ct;
+    uint8_t K[SPARROW_K_SZ];
+} bo;
+
+static void bo_prep(void)
+{
+    polyr_copy(bo.r, bo.v);
+}
+
+//  with the hint randomness, which help_recvec() also draws
+
+static void bo_enc_out_fused(void)
+{
+    help_rand(bo.rnd);
+    polyr_intt_help(bo.K, bo.ct.ct, bo.r, bo.y, bo.rnd);
+}
+
+static void bo_enc_out_separate(void)
+{
+    polyr_intt(bo.r);
+    polyr_addq(bo.r, bo.r, bo.y);
+    help_recvec(bo.r, &bo.ct);
+    rec_vec(bo.K, bo.r, &bo.ct);
+}
+
+static void bo_dec_out_fused(void)
+{
+    polyr_intt_rec(bo.K, bo.r, bo.y, bo.ct.ct);
+}
+
+static void bo_dec_out_separate(void)
+{
+    polyr_intt(bo.r);
+    polyr_addq(bo.r, bo.r, bo.y);
+    rec_vec(bo.K, bo.r, &bo.ct);
+}
+
+//  Reduced v, decaps noise, and the hints of encaps.
+
+static void bo_init(void)
+{
+    size_t i;
+
+    for (i = 0; i < SPARROW_N; i++) {
+        bo.v[i] = (i * 1103515245 + 12345) % SPARROW_Q;
+    }
+    large_sample_gauss_vector(bo.y, SPARROW_N);
+    bo_prep();
+    bo_enc_out_fused();
+}
+
+const bench_set_t bench_set = {
+    SPARROW_NAME, bo_init, bo_prep,
+    bo_enc_out_fused, bo_enc_out_separate,
+    bo_dec_out_fused, bo_dec_out_separate
+};
@@ -0,0 +1,31 @@
+//  bench_set.h
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Kernels of one parameter set for xbench; bench_set.c is compiled
+//      for every set of the build and defines SPARROW_(bench_set).
+
+#ifndef _BENCH_SET_H_
+#define _BENCH_SET_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//  "init" sets up the inputs once, "prep" restores them before each call.
+
+typedef struct {
+    const char *name;                   //  SPARROW_NAME
+    void (*init)(void);
+    void (*prep)(void);
+    void (*enc_out_fused)(void);        //  polyr_intt_help()
+    void (*enc_out_separate)(void);     //  intt, addq, help_recvec, rec_vec
+    void (*dec_out_fused)(void);        //  polyr_intt_rec()
+    void (*dec_out_separate)(void);     //  intt, addq, rec_vec
+} bench_set_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+//  _BENCH_SET_H_
+#endif
@@ -0,0 +1,158 @@
+//  plat_perf.c
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Hardware performance counters via Linux perf_event_open().
+
+#include <string.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "plat_perf.h"
+
+static const char *plat_perf_names[PLAT_PERF_EVENTS] = {
+    "cycles", "instr", "l1d-miss", "llc-miss", "br-miss"
+};
+
+//  Short name of event "i".
+
+const char *plat_perf_name(int i)
+{
+    return i >= 0 && i < PLAT_PERF_EVENTS ? plat_perf_names[i] : "?";
+}
+
+#ifdef __linux__
+
+//  (type, config) of each event
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} plat_perf_ev[PLAT_PERF_EVENTS] = {
+    { PERF_TYPE_HARDWARE,   PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE,   PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HW_CACHE,   PERF_COUNT_HW_CACHE_L1D |
+                            (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                            (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { PERF_TYPE_HARDWARE,   PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_HARDWARE,   PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+//  Open the counters (stopped); the cycle counter leads the group.
+
+int plat_perf_open(plat_perf_t *pp)
+{
+    int i, fd;
+    struct perf_event_attr attr;
+
+    pp->nr = 0;
+    for (i = 0; i < PLAT_PERF_EVENTS; i++) {
+        pp->fd[i] = -1;
+        pp->idx[i] = -1;
+
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = plat_perf_ev[i].type;
+        attr.config = plat_perf_ev[i].config;
+        attr.disabled = (i == 0);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP |
+                           PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        fd = syscall(SYS_perf_event_open, &attr, 0, -1,
+                     i == 0 ? -1 : pp->fd[0], 0);
+        if (fd < 0) {
+            if (i == 0)
+                return -1;
+            continue;
+        }
+        pp->fd[i] = fd;
+        pp->idx[i] = pp->nr++;
+    }
+    return pp->nr;
+}
+
+//  Zero and start the counters.
+
+int plat_perf_start(const plat_perf_t *pp)
+{
+    if (pp->nr <= 0 ||
+        ioctl(pp->fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP) != 0 ||
+        ioctl(pp->fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP) != 0)
+        return -1;
+    return 0;
+}
+
+//  Stop the counters, then read them into "v": the read() is not counted.
+//  The group read is { nr, time enabled, time running, values[nr] }.
+
+int plat_perf_stop(const plat_perf_t *pp, uint64_t v[PLAT_PERF_EVENTS])
+{
+    int i;
+    uint64_t buf[3 + PLAT_PERF_EVENTS];
+
+    memset(v, 0, PLAT_PERF_EVENTS * sizeof(uint64_t));
+    if (pp->nr <= 0 ||
+        ioctl(pp->fd[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP) != 0 ||
+        read(pp->fd[0], buf, sizeof(buf)) < (ssize_t) (8 * (3 + pp->nr)))
+        return -1;
+
+    //  multiplexed with other event groups: the counts are partial
+    if (buf[2] != buf[1])
+        return -1;
+
+    for (i = 0; i < PLAT_PERF_EVENTS; i++) {
+        v[i] = pp->idx[i] >= 0 ? buf[3 + pp->idx[i]] : 0;
+    }
+    return 0;
+}
+
+//  Stop and close the counters.
+
+void plat_perf_close(plat_perf_t *pp)
+{
+    int i;
+
+    for (i = PLAT_PERF_EVENTS - 1; i >= 0; i--) {
+        if (pp->fd[i] >= 0)
+            close(pp->fd[i]);
+        pp->fd[i] = -1;
+        pp->idx[i] = -1;
+    }
+    pp->nr = 0;
+}
+
+#else
+
+int plat_perf_open(plat_perf_t *pp)
+{
+    pp->nr = 0;
+    return -1;
+}
+
+int plat_perf_start(const plat_perf_t *pp)
+{
+    (void) pp;
+    return -1;
+}
+
+int plat_perf_stop(const plat_perf_t *pp, uint64_t v[PLAT_PERF_EVENTS])
+{
+    (void) pp;
+    memset(v, 0, PLAT_PERF_EVENTS * sizeof(uint64_t));
+    return -1;
+}
+
+void plat_perf_close(plat_perf_t *pp)
+{
+    pp->nr = 0;
+}
+
+//  __linux__
+#endif
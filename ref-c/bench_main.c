@@ -0,0 +1,756 @@
+//  bench_main.c
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Statistical microbenchmarks of the kernels and the api.h functions:
+//      cycles per call (median, minimum, mean, standard deviation) after a
+//      warm-up, on a pinned CPU, optionally with hardware counters, written
+//      as JSON and compared against a stored baseline.
+
+#ifndef NIST_KAT
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "plat_local.h"
+#include "plat_cpu.h"
+#include "plat_perf.h"
+#include "sparrow_core.h"
+#include "sparrow_serial.h"
+#include "polyr.h"
+#include "xof_sample.h"
+#include "gauss_sample.h"
+#include "sparrow_rec.h"
+#include "keccakf1600.h"
+#include "nist_random.h"
+#include "sparrow_kem.h"
+#include "ct_util.h"
+#include "param_list.h"
+#include "bench/bench_set.h"
+#include "api.h"
+
+//  default number of timed runs; warm-up runs are a tenth of that
+#define BENCH_RUNS  1000
+
+//  default regression threshold for -b (median, percent)
+#define BENCH_SLOWER    10.0
+
+//  default number of measurements of each kernel; the lowest median counts
+#define BENCH_REPS      3
+
+//  ciphertexts per crypto_decaps_batch() call
+#define BENCH_BATCH     16
+
+//  === Benchmarked kernels; all state is in "bk"
+
+static struct {
+    uint64_t kec[25];
+    uint64_t kec4[4 * 25];
+    gauss_stream_t gs;
+    uint8_t seed[8];
+    int64_t a[SPARROW_N], b[SPARROW_N], c[SPARROW_N], r[SPARROW_N];
+    int64_t y[SPARROW_N];
+    uint64_t rnd[REC_RAND_WORDS];
+    int64_t m[SPARROW_N], v[SPARROW_N];
+    int64_t s[SPARROW_ELL][SPARROW_N];
+    racc_pk_t pk;
+    racc_sk_t sk;
+    racc_ciphertext_t ct, ct_r;
+    uint8_t K[CRYPTO_SHAREDKEY];
+    uint8_t ct_b[CRYPTO_BYTES];
+    uint8_t pkA[CRYPTO_PUBLICKEYBYTES], skA[CRYPTO_SECRETKEYBYTES];
+    uint8_t pkB[CRYPTO_PUBLICKEYBYTES], skB[CRYPTO_SECRETKEYBYTES];
+    uint8_t pkC[CRYPTO_PUBLICKEYBYTES], skC[CRYPTO_SECRETKEYBYTES];
+    uint8_t K_bat[BENCH_BATCH * CRYPTO_SHAREDKEY];
+    uint8_t ct_bat[BENCH_BATCH * CRYPTO_BYTES];
+    uint8_t pk_bat[BENCH_BATCH * CRYPTO_PUBLICKEYBYTES];
+    const sparrow_kem_t *kem;
+    const bench_set_t *set;             //  the kernels of kem's set
+    uint8_t *kpkA, *kskA, *kpkB, *kskB, *kpkC, *kskC, *kct, *kK;
+#ifdef SPARROW_CT_STATS
+    uint64_t wipes[3], wipe_len[3];     //  keypair, encaps, decaps
+    uint8_t *wipe_buf;
+#endif
+} bk;
+
+static void bk_keccak(void)         { keccak_f1600(bk.kec); }
+static void bk_keccak_x4(void)      { keccak_f1600_x4(bk.kec4); }
+static void bk_xof_sample_q(void)   { xof_sample_q(bk.r, bk.seed, 8); }
+static void bk_small_gauss(void)    { small_sample_gauss_vector(bk.y, SPARROW_N); }
+static void bk_gauss_stream(void)   { gauss_stream_small(&bk.gs, bk.y, SPARROW_CTBITS); }
+static void bk_large_gauss(void)    { large_sample_gauss_vector(bk.y, SPARROW_CTBITS); }
+static void bk_copy_a(void)         { polyr_copy(bk.r, bk.a); }
+static void bk_fntt(void)           { polyr_fntt(bk.r); }
+static void bk_intt(void)           { polyr_intt(bk.r); }
+static void bk_mula(void)           { polyr_ntt_mula(bk.r, bk.a, bk.b, bk.c); }
+static void bk_small_mula(void)     { polyr_small_mula(bk.r, bk.a, bk.s[0], bk.c); }
+static void bk_help_recvec(void)    { help_recvec(bk.a, &bk.ct_r); }
+static void bk_rec_vec(void)        { rec_vec(bk.K, bk.a, &bk.ct_r); }
+static void bk_encode_pk(void)      { racc_encode_pk(bk.pkA, &bk.pk); }
+static void bk_decode_pk(void)      { racc_decode_pk(&bk.pk, bk.pkA); }
+static void bk_encode_sk(void)      { racc_encode_sk(bk.skA, &bk.sk); }
+static void bk_decode_sk(void)      { racc_decode_sk(&bk.sk, bk.skA); }
+static void bk_encode_ct(void)      { racc_encode_ct(bk.ct_b, &bk.ct); }
+static void bk_decode_ct(void)      { racc_decode_ct(&bk.ct, bk.ct_b); }
+static void bk_keypair(void)        { crypto_sign_keypair(bk.pkC, bk.skC, 0); }
+static void bk_encaps(void)         { crypto_encaps(bk.K, bk.ct_b, bk.pkA, bk.skB); }
+static void bk_decaps(void)         { crypto_decaps(bk.K, bk.ct_b, bk.pkB, bk.skA); }
+static void bk_decaps_batch(void)   { crypto_decaps_batch(bk.K_bat, bk.ct_bat, bk.pk_bat, bk.skA, BENCH_BATCH); }
+static void bk_kem_keypair(void)    { bk.kem->keypair(bk.kpkC, bk.kskC, 0); }
+static void bk_kem_encaps(void)     { bk.kem->encaps(bk.kK, bk.kct, bk.kpkA, bk.kskB); }
+static void bk_kem_decaps(void)     { bk.kem->decaps(bk.kK, bk.kct, bk.kpkB, bk.kskA); }
+static void bk_kem_out_prep(void)   { bk.set->prep(); }
+static void bk_kem_enc_out_fused(void)      { bk.set->enc_out_fused(); }
+static void bk_kem_enc_out_separate(void)   { bk.set->enc_out_separate(); }
+static void bk_kem_dec_out_fused(void)      { bk.set->dec_out_fused(); }
+static void bk_kem_dec_out_separate(void)   { bk.set->dec_out_separate(); }
+
+//  each set's bench/bench_set.c defines SPARROW_(bench_set)
+
+#define BENCH_SET_DECL(set) extern const bench_set_t set##_bench_set;
+SPARROW_BUILD_SETS(BENCH_SET_DECL)
+
+#define BENCH_SET_PTR(set) &set##_bench_set,
+static const bench_set_t *const bench_sets[] = {
+    SPARROW_BUILD_SETS(BENCH_SET_PTR)
+};
+
+#ifdef SPARROW_CT_STATS
+
+//  The ct_memzero() calls of operation "op", as counted in bench_init(),
+//  replayed with their mean length: the wiping cost of the operation.
+
+static void bk_wipe(int op)
+{
+    uint64_t i;
+
+    for (i = 0; i < bk.wipes[op]; i++) {
+        ct_memzero(bk.wipe_buf, bk.wipe_len[op]);
+    }
+}
+
+static void bk_wipe_keypair(void)   { bk_wipe(0); }
+static void bk_wipe_encaps(void)    { bk_wipe(1); }
+static void bk_wipe_decaps(void)    { bk_wipe(2); }
+
+//  SPARROW_CT_STATS
+#endif
+
+static void bk_intt_help(void)      { polyr_intt_help(bk.K, bk.ct_r.ct, bk.r, bk.y, bk.rnd); }
+static void bk_intt_rec(void)       { polyr_intt_rec(bk.K, bk.r, bk.y, bk.ct.ct); }
+
+//  The products of keygen (t = A * s, with A sampled in the normal
+//  domain) and encaps (v = t * s) with the NTT and with small
+//  multiplication. Keygen would transform s for the secret key either way.
+
+static void bk_keygen_mul_ntt(void)
+{
+    size_t i, j;
+
+    for (i = 0; i < SPARROW_K; i++) {
+        polyr_zero(bk.v);
+        for (j = 0; j < SPARROW_ELL; j++) {
+            polyr_copy(bk.m, bk.a);
+            polyr_fntt(bk.m);
+            polyr_ntt_mula(bk.v, bk.sk.s[j], bk.m, bk.v);
+        }
+        polyr_intt(bk.v);
+    }
+}
+
+static void bk_keygen_mul_small(void)
+{
+    size_t i, j;
+
+    for (i = 0; i < SPARROW_K; i++) {
+        polyr_zero(bk.v);
+        for (j = 0; j < SPARROW_ELL; j++) {
+            polyr_small_mula(bk.v, bk.a, bk.s[j], bk.v);
+        }
+    }
+}
+
+static void bk_encaps_mul_ntt(void)
+{
+    size_t i;
+
+    polyr_zero(bk.v);
+    for (i = 0; i < SPARROW_K; i++) {
+        polyr_copy(bk.m, bk.pk.t[i]);
+        polyr_fntt(bk.m);
+        polyr_ntt_mula(bk.v, bk.sk.s[i], bk.m, bk.v);
+    }
+    polyr_intt(bk.v);
+}
+
+static void bk_encaps_mul_small(void)
+{
+    size_t i;
+
+    polyr_zero(bk.v);
+    for (i = 0; i < SPARROW_K; i++) {
+        polyr_small_mula(bk.v, bk.pk.t[i], bk.s[i], bk.v);
+    }
+}
+
+//  "prep" (untimed, may be NULL) runs before each timed call of "run"
+
+typedef struct {
+    const char *name;
+    void (*prep)(void);
+    void (*run)(void);
+} bench_kernel_t;
+
+static const bench_kernel_t bench_kernels[] = {
+    { "keccak_f1600",       NULL,           bk_keccak       },
+    { "keccak_f1600_x4",    NULL,           bk_keccak_x4    },
+    { "xof_sample_q",       NULL,           bk_xof_sample_q },
+    { "small_gauss_n",      NULL,           bk_small_gauss  },
+    { "gauss_stream_ctbits", NULL,          bk_gauss_stream },
+    { "large_gauss_ctbits", NULL,           bk_large_gauss  },
+    { "polyr_fntt",         bk_copy_a,      bk_fntt         },
+    { "polyr_intt",         bk_copy_a,      bk_intt         },
+    { "polyr_ntt_mula",     NULL,           bk_mula         },
+    { "polyr_small_mula",   NULL,           bk_small_mula   },
+    { "keygen_mul_ntt",     NULL,           bk_keygen_mul_ntt },
+    { "keygen_mul_small",   NULL,           bk_keygen_mul_small },
+    { "encaps_mul_ntt",     NULL,           bk_encaps_mul_ntt },
+    { "encaps_mul_small",   NULL,           bk_encaps_mul_small },
+    { "help_recvec",        NULL,           bk_help_recvec  },
+    { "rec_vec",            NULL,           bk_rec_vec      },
+    { "polyr_intt_help",    bk_copy_a,      bk_intt_help    },
+    { "polyr_intt_rec",     bk_copy_a,      bk_intt_rec     },
+    { "encode_pk",          NULL,           bk_encode_pk    },
+    { "decode_pk",          NULL,           bk_decode_pk    },
+    { "encode_sk",          NULL,           bk_encode_sk    },
+    { "decode_sk",          NULL,           bk_decode_sk    },
+    { "encode_ct",          NULL,           bk_encode_ct    },
+    { "decode_ct",          NULL,           bk_decode_ct    },
+    { "crypto_keypair",     NULL,           bk_keypair      },
+    { "crypto_encaps",      NULL,           bk_encaps       },
+    { "crypto_decaps",      NULL,           bk_decaps       },
+    { "crypto_decaps_batch", NULL,          bk_decaps_batch },
+#ifdef SPARROW_CT_STATS
+    { "wipe_keypair",       NULL,           bk_wipe_keypair },
+    { "wipe_encaps",        NULL,           bk_wipe_encaps  },
+    { "wipe_decaps",        NULL,           bk_wipe_decaps  },
+#endif
+    { "kem_keypair",        NULL,           bk_kem_keypair  },
+    { "kem_encaps",         NULL,           bk_kem_encaps   },
+    { "kem_decaps",         NULL,           bk_kem_decaps   },
+    { "kem_enc_out_fused",  bk_kem_out_prep, bk_kem_enc_out_fused },
+    { "kem_enc_out_separate", bk_kem_out_prep, bk_kem_enc_out_separate },
+    { "kem_dec_out_fused",  bk_kem_out_prep, bk_kem_dec_out_fused },
+    { "kem_dec_out_separate", bk_kem_out_prep, bk_kem_dec_out_separate },
+};
+
+#define BENCH_KERNELS (sizeof(bench_kernels) / sizeof(bench_kernels[0]))
+
+//  Inputs: reduced polynomials and valid keys and ciphertext.
+
+static void bench_init(void)
+{
+    size_t i;
+
+    for (i = 0; i < SPARROW_N; i++) {
+        bk.a[i] = (i * 1103515245 + 12345) % SPARROW_Q;
+        bk.b[i] = (i * 2654435761u) % SPARROW_Q;
+        bk.c[i] = (i * 40503) % SPARROW_Q;
+    }
+    memset(bk.seed, 'A', sizeof(bk.seed));
+    crypto_sign_keypair(bk.pkA, bk.skA, 0);
+    crypto_sign_keypair(bk.pkB, bk.skB, 1);
+    crypto_encaps(bk.K, bk.ct_b, bk.pkA, bk.skB);
+    racc_decode_pk(&bk.pk, bk.pkA);
+    racc_decode_sk(&bk.sk, bk.skA);
+    racc_decode_ct(&bk.ct, bk.ct_b);
+    bk.ct_r = bk.ct;
+    polyr_copy(bk.r, bk.a);
+    gauss_stream_init(&bk.gs);
+    large_sample_gauss_vector(bk.y, SPARROW_N);
+    for (i = 0; i < SPARROW_ELL; i++) {
+        small_sample_gauss_vector(bk.s[i], SPARROW_N);
+    }
+    help_rand(bk.rnd);
+    for (i = 0; i < BENCH_BATCH; i++) {
+        memcpy(bk.ct_bat + i * CRYPTO_BYTES, bk.ct_b, CRYPTO_BYTES);
+        memcpy(bk.pk_bat + i * CRYPTO_PUBLICKEYBYTES, bk.pkB,
+               CRYPTO_PUBLICKEYBYTES);
+    }
+
+    //  the kem_* kernels: set bk.kem through the runtime table
+    bk.kpkA = malloc(3 * (bk.kem->pk_sz + bk.kem->sk_sz) + bk.kem->ct_sz +
+                     bk.kem->k_sz);
+    bk.kskA = bk.kpkA + bk.kem->pk_sz;
+    bk.kpkB = bk.kskA + bk.kem->sk_sz;
+    bk.kskB = bk.kpkB + bk.kem->pk_sz;
+    bk.kpkC = bk.kskB + bk.kem->sk_sz;
+    bk.kskC = bk.kpkC + bk.kem->pk_sz;
+    bk.kct = bk.kskC + bk.kem->sk_sz;
+    bk.kK = bk.kct + bk.kem->ct_sz;
+    bk.kem->keypair(bk.kpkA, bk.kskA, 0);
+    bk.kem->keypair(bk.kpkB, bk.kskB, 1);
+    bk.kem->encaps(bk.kK, bk.kct, bk.kpkA, bk.kskB);
+    for (i = 0; i < sizeof(bench_sets) / sizeof(bench_sets[0]); i++) {
+        if (strcmp(bench_sets[i]->name, bk.kem->name) == 0)
+            bk.set = bench_sets[i];
+    }
+    bk.set->init();
+
+#ifdef SPARROW_CT_STATS
+    //  count the wipes of each operation for the wipe_* kernels
+    ct_wipe_stat_t *wst = ct_wipe_stat();
+    size_t max_len = 0;
+
+    for (i = 0; i < 3; i++) {
+        wst->calls = 0;
+        wst->bytes = 0;
+        if (i == 0)
+            bk_keypair();
+        else if (i == 1)
+            bk_encaps();
+        else
+            bk_decaps();
+        bk.wipes[i] = wst->calls;
+        bk.wipe_len[i] = wst->calls > 0 ? wst->bytes / wst->calls : 0;
+        if (bk.wipe_len[i] > max_len)
+            max_len = bk.wipe_len[i];
+    }
+    bk.wipe_buf = malloc(max_len + 1);
+#endif
+}
+
+//  === Statistics
+
+typedef struct {
+    const char *name;
+    size_t runs;
+    double median, min, mean, sd;
+    double ev[PLAT_PERF_EVENTS];    //  counts per call (mean) with -p
+} bench_res_t;
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+//  Time "runs" calls of kernel "k" after "warm" untimed ones. With
+//  counters "pp" the times are core cycles, otherwise plat_get_cycle().
+//  A call whose counts were multiplexed is repeated; returns -1 if more
+//  than "runs" were.
+
+static int bench_kernel(bench_res_t *res, const bench_kernel_t *k,
+                        uint64_t *x, size_t runs, size_t warm,
+                        const plat_perf_t *pp)
+{
+    size_t i, mux;
+    int j;
+    uint64_t cc, v[PLAT_PERF_EVENTS];
+    double d;
+
+    for (i = 0; i < warm; i++) {
+        if (k->prep != NULL)
+            k->prep();
+        k->run();
+    }
+    memset(res->ev, 0, sizeof(res->ev));
+    mux = 0;
+    for (i = 0; i < runs; ) {
+        if (k->prep != NULL)
+            k->prep();
+        if (pp != NULL) {
+            plat_perf_start(pp);
+            k->run();
+            if (plat_perf_stop(pp, v) != 0) {
+                if (++mux > runs)
+                    return -1;
+                continue;
+            }
+            x[i] = v[PLAT_PERF_CYCLES];
+            for (j = 0; j < PLAT_PERF_EVENTS; j++) {
+                res->ev[j] += (double) v[j];
+            }
+        } else {
+            cc = plat_get_cycle();
+            k->run();
+            x[i] = plat_get_cycle() - cc;
+        }
+        i++;
+    }
+    for (j = 0; j < PLAT_PERF_EVENTS; j++) {
+        res->ev[j] /= (double) runs;
+    }
+
+    res->name = k->name;
+    res->runs = runs;
+    res->mean = 0.0;
+    for (i = 0; i < runs; i++) {
+        res->mean += (double) x[i];
+    }
+    res->mean /= (double) runs;
+    res->sd = 0.0;
+    for (i = 0; i < runs; i++) {
+        d = (double) x[i] - res->mean;
+        res->sd += d * d;
+    }
+    res->sd = runs > 1 ? sqrt(res->sd / (double) (runs - 1)) : 0.0;
+
+    qsort(x, runs, sizeof(uint64_t), cmp_u64);
+    res->min = (double) x[0];
+    res->median = (runs & 1) ? (double) x[runs / 2] :
+                  0.5 * ((double) x[runs / 2 - 1] + (double) x[runs / 2]);
+
+    return 0;
+}
+
+//  Write the results as JSON to "fn".
+
+static int bench_json(const char *fn, const bench_res_t *res, size_t n,
+                      int cpu, int perf, int reps)
+{
+    size_t i;
+    int j;
+    FILE *f;
+
+    f = fopen(fn, "w");
+    if (f == NULL) {
+        perror(fn);
+        return -1;
+    }
+    fprintf(f, "{\n  \"set\": \"%s\",\n  \"kem_set\": \"%s\",\n"
+            "  \"cpu_level\": \"%s\",\n  \"cpu\": %d,\n  \"unit\": \"%s\",\n"
+            "  \"reps\": %d,\n  \"results\": [\n", CRYPTO_ALGNAME,
+            bk.kem->name, plat_cpu_name(plat_cpu_level()), cpu,
+            perf ? "core cycles" : "cycles", reps);
+    for (i = 0; i < n; i++) {
+        fprintf(f, "    { \"name\": \"%s\", \"runs\": %zu, \"median\": %.1f, "
+                "\"min\": %.1f, \"mean\": %.1f, \"sd\": %.1f",
+                res[i].name, res[i].runs, res[i].median, res[i].min,
+                res[i].mean, res[i].sd);
+        for (j = 1; perf && j < PLAT_PERF_EVENTS; j++) {
+            fprintf(f, ", \"%s\": %.1f", plat_perf_name(j), res[i].ev[j]);
+        }
+        fprintf(f, " }%s\n", i + 1 < n ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+
+    return 0;
+}
+
+//  Medians from a JSON file written by bench_json(); the parser only
+//  handles that format (one result per line). Returns the number of
+//  results, or -1 if the file cannot be read.
+
+typedef struct {
+    char name[32];
+    double median;
+} bench_base_t;
+
+//  the settings the baseline was measured with
+typedef struct {
+    char set[32];                   //  kernels
+    char kem_set[32];               //  kem_* rows (-k)
+    char level[32];
+    int reps;
+} bench_hdr_t;
+
+#define BENCH_BASE_MAX  (4 * BENCH_KERNELS)
+
+static int bench_load(const char *fn, bench_base_t *base, size_t max,
+                      bench_hdr_t *hdr)
+{
+    size_t n;
+    char line[256], *p;
+    FILE *f;
+
+    f = fopen(fn, "r");
+    if (f == NULL) {
+        perror(fn);
+        return -1;
+    }
+    n = 0;
+    memset(hdr, 0, sizeof(bench_hdr_t));
+    hdr->reps = 1;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if ((p = strstr(line, "\"set\": \"")) != NULL) {
+            snprintf(hdr->set, sizeof(hdr->set), "%s", p + 8);
+            hdr->set[strcspn(hdr->set, "\"")] = 0;
+        }
+        if ((p = strstr(line, "\"kem_set\": \"")) != NULL) {
+            snprintf(hdr->kem_set, sizeof(hdr->kem_set), "%s", p + 12);
+            hdr->kem_set[strcspn(hdr->kem_set, "\"")] = 0;
+        }
+        if ((p = strstr(line, "\"cpu_level\": \"")) != NULL) {
+            snprintf(hdr->level, sizeof(hdr->level), "%s", p + 14);
+            hdr->level[strcspn(hdr->level, "\"")] = 0;
+        }
+        if ((p = strstr(line, "\"reps\": ")) != NULL)
+            hdr->reps = atoi(p + 8);
+        if (n >= max || (p = strstr(line, "\"name\": \"")) == NULL)
+            continue;
+        snprintf(base[n].name, sizeof(base[n].name), "%s", p + 9);
+        base[n].name[strcspn(base[n].name, "\"")] = 0;
+        if ((p = strstr(line, "\"median\": ")) == NULL)
+            continue;
+        base[n].median = strtod(p + 10, NULL);
+        n++;
+    }
+    fclose(f);
+
+    return (int) n;
+}
+
+//  Baseline median of kernel "name", 0 if not in the baseline.
+
+static double bench_base_median(const bench_base_t *base, int m,
+                                const char *name)
+{
+    int j;
+
+    for (j = 0; j < m; j++) {
+        if (strcmp(base[j].name, name) == 0)
+            return base[j].median;
+    }
+    return 0.0;
+}
+
+//  Print "res" against the baseline; return the number of kernels whose
+//  median is more than "slower" percent above it, plus (if "all" kernels
+//  ran) those of the baseline that are missing. Rows whose name starts
+//  with "skip" (if not NULL) are not compared.
+
+static int bench_compare(const bench_base_t *base, int m,
+                         const bench_res_t *res, size_t n, double slower,
+                         int all, const char *skip)
+{
+    int bad, j, miss;
+    size_t i;
+    double b, d;
+
+    printf("%-20s %12s %12s %9s\t(threshold +%.1f %%)\n",
+           "median", "baseline", "now", "change", slower);
+    bad = 0;
+    for (i = 0; i < n; i++) {
+        if (skip != NULL && strncmp(res[i].name, skip, strlen(skip)) == 0)
+            continue;
+        b = bench_base_median(base, m, res[i].name);
+        if (b <= 0.0) {
+            printf("%-20s %12s %12.0f %9s\n", res[i].name, "-",
+                   res[i].median, "new");
+            continue;
+        }
+        d = 100.0 * (res[i].median / b - 1.0);
+        printf("%-20s %12.0f %12.0f %+8.1f%%%s\n", res[i].name,
+               b, res[i].median, d, d > slower ? "\tREGRESSION" : "");
+        bad += d > slower;
+    }
+    miss = 0;
+    for (j = 0; all && j < m; j++) {
+        if (skip != NULL && strncmp(base[j].name, skip, strlen(skip)) == 0)
+            continue;
+        for (i = 0; i < n && strcmp(res[i].name, base[j].name) != 0; i++)
+            ;
+        if (i == n) {
+            printf("%-20s %12.0f %12s %9s\n", base[j].name, base[j].median,
+                   "-", "missing");
+            miss++;
+        }
+    }
+    printf("%d regression%s, %d missing\n", bad, bad == 1 ? "" : "s",
+           miss);
+
+    return bad + miss;
+}
+
+//  Pin to "cpu" (the current one if negative); return the CPU or -1.
+
+static int bench_pin(int cpu)
+{
+#ifdef __linux__
+    cpu_set_t set;
+
+    if (cpu < 0)
+        cpu = sched_getcpu();
+    if (cpu < 0)
+        return -1;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0)
+        return -1;
+    return cpu;
+#else
+    (void) cpu;
+    return -1;
+#endif
+}
+
+//  xbench [-n runs] [-w warm-up runs] [-r reps] [-c cpu] [-p]
+//         [-o results.json] [-b baseline.json] [-t percent] [-k set] [name]
+
+int main(int argc, char **argv)
+{
+    int opt, cpu, m, r, j, perf, reps;
+    plat_perf_t pp;
+    size_t i, n, runs, warm;
+    uint8_t seed[48];
+    double slower;
+    bench_hdr_t hdr;
+    bench_res_t tmp;
+    bench_base_t bb[BENCH_BASE_MAX];
+    const char *json = NULL, *filter = NULL, *base = NULL;
+    const char *kem = CRYPTO_ALGNAME, *skip = NULL;
+    uint64_t *x;
+    bench_res_t res[BENCH_KERNELS];
+
+    runs = BENCH_RUNS;
+    warm = 0;
+    reps = BENCH_REPS;
+    cpu = -1;
+    slower = BENCH_SLOWER;
+    perf = 0;
+    while ((opt = getopt(argc, argv, "n:w:r:c:po:b:t:k:")) != -1) {
+        switch (opt) {
+            case 'p':   perf = 1;                           break;
+            case 'n':   runs = strtoul(optarg, NULL, 0);    break;
+            case 'w':   warm = strtoul(optarg, NULL, 0);    break;
+            case 'r':   reps = atoi(optarg);                break;
+            case 'c':   cpu = atoi(optarg);                 break;
+            case 'o':   json = optarg;                      break;
+            case 'b':   base = optarg;                      break;
+            case 't':   slower = strtod(optarg, NULL);      break;
+            case 'k':   kem = optarg;                       break;
+            default:
+                fprintf(stderr, "usage: %s [-n runs] [-w warm-up runs] "
+                        "[-r reps] [-c cpu] [-p] [-o results.json] "
+                        "[-b baseline.json] [-t percent] [-k set] [name]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    bk.kem = sparrow_kem_by_name(kem);
+    if (bk.kem == NULL) {
+        fprintf(stderr, "%s: unknown parameter set %s\n", argv[0], kem);
+        return 1;
+    }
+    if (optind < argc)
+        filter = argv[optind];
+    if (runs == 0)
+        runs = 1;
+    if (warm == 0)
+        warm = runs / 10 + 1;
+    if (reps < 1)
+        reps = 1;
+
+    m = 0;
+    if (base != NULL) {
+        m = bench_load(base, bb, BENCH_BASE_MAX, &hdr);
+        if (m < 0)
+            return 1;
+
+        //  only like with like: same sets, CPU level and sampling
+        if (strcmp(hdr.set, CRYPTO_ALGNAME) != 0) {
+            printf("baseline %s: set %s, now %s\n", base, hdr.set,
+                   CRYPTO_ALGNAME);
+            return 1;
+        }
+        if (strcmp(hdr.kem_set, bk.kem->name) != 0) {
+            printf("(baseline %s: kem_* of %s, now %s; not compared)\n",
+                   base, hdr.kem_set, bk.kem->name);
+            skip = "kem_";
+        }
+        if (strcmp(hdr.level, plat_cpu_name(plat_cpu_level())) != 0) {
+            printf("baseline %s: cpu level %s, now %s\n", base, hdr.level,
+                   plat_cpu_name(plat_cpu_level()));
+            return 1;
+        }
+        if (hdr.reps != reps) {
+            printf("baseline %s: lowest median of %d, now of %d (-r)\n",
+                   base, hdr.reps, reps);
+            return 1;
+        }
+    }
+
+    for (i = 0; i < 48; i++) {
+        seed[i] = i;
+    }
+    nist_randombytes_init(seed, NULL, 256);
+
+    //  counters follow the thread, so open them after pinning
+    cpu = bench_pin(cpu);
+    if (perf && plat_perf_open(&pp) < 0) {
+        printf("(perf_event_open() failed: no hardware counters; "
+               "check /proc/sys/kernel/perf_event_paranoid)\n");
+        perf = 0;
+    }
+    printf("%s\tcpu %d (%s)\t%zu runs, %zu warm-up\tkem_*: %s\n",
+           CRYPTO_ALGNAME, cpu, plat_cpu_name(plat_cpu_level()), runs, warm,
+           bk.kem->name);
+    printf("%-20s %12s %12s %12s %10s", perf ? "core cycles" : "cycles",
+           "median", "min", "mean", "sd");
+    for (j = 1; perf && j < PLAT_PERF_EVENTS; j++) {
+        printf(" %10s", plat_perf_name(j));
+    }
+    printf(perf ? "   ipc\n" : "\n");
+
+    bench_init();
+    x = malloc(runs * sizeof(uint64_t));
+    n = 0;
+    for (i = 0; i < BENCH_KERNELS; i++) {
+        if (filter != NULL && strstr(bench_kernels[i].name, filter) == NULL)
+            continue;
+        //  the lowest median of "reps" measurements, the same with and
+        //  without a baseline, so that one disturbed run does not count
+        for (r = 0; r < reps; r++) {
+            if (bench_kernel(r == 0 ? &res[n] : &tmp, &bench_kernels[i], x,
+                             runs, warm, perf ? &pp : NULL) != 0) {
+                printf("%s: counters multiplexed with other events (another "
+                       "perf user?)\n", bench_kernels[i].name);
+                return 1;
+            }
+            if (r > 0 && tmp.median < res[n].median)
+                res[n] = tmp;
+        }
+        printf("%-20s %12.0f %12.0f %12.0f %10.1f", res[n].name,
+               res[n].median, res[n].min, res[n].mean, res[n].sd);
+        for (j = 1; perf && j < PLAT_PERF_EVENTS; j++) {
+            printf(" %10.1f", res[n].ev[j]);
+        }
+        if (perf) {
+            printf("  %5.2f", res[n].ev[PLAT_PERF_CYCLES] > 0.0 ?
+                   res[n].ev[PLAT_PERF_INSTR] / res[n].ev[PLAT_PERF_CYCLES] :
+                   0.0);
+        }
+        printf("\n");
+        n++;
+    }
+    free(x);
+    free(bk.kpkA);
+    if (perf)
+        plat_perf_close(&pp);
+
+    if (json != NULL && bench_json(json, res, n, cpu, perf, reps) != 0)
+        return 1;
+
+    //  exit status 1 on regressions or missing kernels
+    if (base != NULL && bench_compare(bb, m, res, n, slower,
+                                      filter == NULL, skip) != 0)
+        return 1;
+
+    return 0;
+}
+
+// NIST_KAT
+#endif
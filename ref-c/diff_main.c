@@ -0,0 +1,528 @@
+//  diff_main.c
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Differential test of the backends: every kernel runs on the same
+//      pseudorandom inputs at each CPU level, and its output must match
+//      the portable one bit for bit. Reports the first divergence.
+
+#ifndef NIST_KAT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "plat_local.h"
+#include "plat_cpu.h"
+#include "sparrow_core.h"
+#include "sparrow_serial.h"
+#include "polyr.h"
+#include "xof_sample.h"
+#include "gauss_sample.h"
+#include "sparrow_rec.h"
+#include "keccakf1600.h"
+#include "aes256_ctr.h"
+#include "nist_random.h"
+#include "api.h"
+
+//  default number of inputs per kernel (divided by the kernel's "div")
+#define DIFF_INPUTS     1000000
+
+//  largest output of a kernel in bytes
+#define DIFF_OUT_SZ     (1 << 16)
+
+//  inputs come from splitmix64, seeded per (seed, kernel, input index) so
+//  that any one input can be rerun alone
+
+static inline uint64_t diff_rand(uint64_t *x)
+{
+    uint64_t z;
+
+    z = (*x += 0x9E3779B97F4A7C15llu);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9llu;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBllu;
+    return z ^ (z >> 31);
+}
+
+//  uniform-ish in [0, m) (the small bias does not matter here)
+
+static inline int64_t diff_mod(uint64_t *x, int64_t m)
+{
+    return (int64_t) (diff_rand(x) % (uint64_t) m);
+}
+
+static void diff_bytes(uint64_t *x, uint8_t *b, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        b[i] = diff_rand(x);
+    }
+}
+
+//  seed the DRBG behind randombytes() for the samplers
+
+static void diff_drbg(uint64_t *x)
+{
+    uint8_t seed[48];
+
+    diff_bytes(x, seed, sizeof(seed));
+    nist_randombytes_init(seed, NULL, 256);
+}
+
+//  === Kernels: each draws its inputs from "x", writes its outputs to
+//      "out", and returns their length
+
+static size_t dk_keccak(uint8_t *out, uint64_t x)
+{
+    size_t i;
+    uint64_t s[25];
+
+    for (i = 0; i < 25; i++) {
+        s[i] = diff_rand(&x);
+    }
+    keccak_f1600(s);
+    memcpy(out, s, sizeof(s));
+    return sizeof(s);
+}
+
+static size_t dk_keccak_x4(uint8_t *out, uint64_t x)
+{
+    size_t i;
+    uint64_t s[4 * 25];
+
+    for (i = 0; i < 4 * 25; i++) {
+        s[i] = diff_rand(&x);
+    }
+    keccak_f1600_x4(s);
+    memcpy(out, s, sizeof(s));
+    return sizeof(s);
+}
+
+//  random key, counter (often about to carry into the high half), and
+//  number of blocks; covers the 8-block loops and their tails
+
+static size_t dk_aes256_ctr(uint8_t *out, uint64_t x)
+{
+    size_t nb;
+    uint8_t key[32], ctr[16];
+    uint32_t rk[AES256_RK_WORDS];
+
+    diff_bytes(&x, key, sizeof(key));
+    diff_bytes(&x, ctr, sizeof(ctr));
+    if (diff_rand(&x) & 1)
+        memset(ctr + 8 + (diff_rand(&x) & 7), 0xFF, 8);
+    nb = 1 + diff_mod(&x, 20);
+
+    aes256_ctr_key(rk, key);
+    aes256_ctr_blocks(out, ctr, nb, rk);
+    memcpy(out + 16 * nb, rk, sizeof(rk));
+    memcpy(out + 16 * nb + sizeof(rk), ctr, sizeof(ctr));
+    return 16 * nb + sizeof(rk) + sizeof(ctr);
+}
+
+static size_t dk_xof_sample_q(uint8_t *out, uint64_t x)
+{
+    size_t len;
+    uint8_t seed[64];
+    int64_t r[SPARROW_N];
+
+    len = 1 + diff_mod(&x, sizeof(seed));
+    diff_bytes(&x, seed, len);
+    xof_sample_q(r, seed, len);
+    memcpy(out, r, sizeof(r));
+    return sizeof(r);
+}
+
+static size_t dk_small_gauss(uint8_t *out, uint64_t x)
+{
+    int64_t y[SPARROW_N];
+
+    diff_drbg(&x);
+    small_sample_gauss_vector(y, SPARROW_N);
+    memcpy(out, y, sizeof(y));
+    return sizeof(y);
+}
+
+//  a few decapsulations' worth of noise in uneven pieces, so that the
+//  requests straddle the blocks and the four-way permutations
+
+static size_t dk_gauss_stream(uint8_t *out, uint64_t x)
+{
+    size_t i, n, len;
+    int64_t y[SPARROW_CTBITS];
+    gauss_stream_t gs;
+
+    diff_drbg(&x);
+    gauss_stream_init(&gs);
+    len = 0;
+    for (i = 0; i < 6; i++) {
+        n = 1 + diff_mod(&x, SPARROW_CTBITS);
+        gauss_stream_small(&gs, y, n);
+        memcpy(out + len, y, n * sizeof(int64_t));
+        len += n * sizeof(int64_t);
+    }
+    gauss_stream_clear(&gs);
+    return len;
+}
+
+static size_t dk_large_gauss(uint8_t *out, uint64_t x)
+{
+    int64_t y[SPARROW_CTBITS];
+
+    diff_drbg(&x);
+    large_sample_gauss_vector(y, SPARROW_CTBITS);
+    memcpy(out, y, sizeof(y));
+    return sizeof(y);
+}
+
+//  input |v[i]| < q
+
+static size_t dk_fntt(uint8_t *out, uint64_t x)
+{
+    size_t i;
+    int64_t v[SPARROW_N];
+
+    for (i = 0; i < SPARROW_N; i++) {
+        v[i] = diff_mod(&x, 2 * SPARROW_Q - 1) - (SPARROW_Q - 1);
+    }
+    polyr_fntt(v);
+    memcpy(out, v, sizeof(v));
+    return sizeof(v);
+}
+
+//  input 0 <= v[i] < q
+
+static size_t dk_intt(uint8_t *out, uint64_t x)
+{
+    size_t i;
+    int64_t v[SPARROW_N];
+
+    for (i = 0; i < SPARROW_N; i++) {
+        v[i] = diff_mod(&x, SPARROW_Q);
+    }
+    polyr_intt(v);
+    memcpy(out, v, sizeof(v));
+    return sizeof(v);
+}
+
+//  a, b in the lazily reduced range of polyr_fntt(), c reduced
+
+#define DIFF_NTT_MAX    ((2 + 2 * SPARROW_LGN) * SPARROW_Q)
+
+static size_t dk_ntt_mul(uint8_t *out, uint64_t x)
+{
+    size_t i;
+    int64_t a[SPARROW_N], b[SPARROW_N], c[SPARROW_N], r[3][SPARROW_N];
+
+    for (i = 0; i < SPARROW_N; i++) {
+        a[i] = diff_mod(&x, DIFF_NTT_MAX);
+        b[i] = diff_mod(&x, DIFF_NTT_MAX);
+        c[i] = diff_mod(&x, SPARROW_Q);
+    }
+    polyr_ntt_mula(r[0], a, b, c);
+    polyr_ntt_cmul(r[1], a, b);
+    polyr_ntt_smul(r[2], a, c[0]);
+    memcpy(out, r, sizeof(r));
+    return sizeof(r);
+}
+
+//  small s; half of the inputs at the extremes s = +-POLYR_SMALL_MAX and
+//  a = +-q/2 (centered) to reach the 32-bit bounds
+
+static size_t dk_small_mula(uint8_t *out, uint64_t x)
+{
+    size_t i;
+    int ext;
+    int64_t a[SPARROW_N], s[SPARROW_N], c[SPARROW_N], r[SPARROW_N];
+
+    ext = diff_rand(&x) & 1;
+    for (i = 0; i < SPARROW_N; i++) {
+        if (ext) {
+            a[i] = SPARROW_Q / 2 + (diff_rand(&x) & 1);
+            s[i] = (diff_rand(&x) & 1) ? POLYR_SMALL_MAX : -POLYR_SMALL_MAX;
+        } else {
+            a[i] = diff_mod(&x, SPARROW_Q);
+            s[i] = diff_mod(&x, 2 * POLYR_SMALL_MAX + 1) - POLYR_SMALL_MAX;
+        }
+        c[i] = diff_mod(&x, SPARROW_Q);
+    }
+    polyr_small_mula(r, a, s, c);
+    memcpy(out, r, sizeof(r));
+    return sizeof(r);
+}
+
+static size_t dk_help_recvec(uint8_t *out, uint64_t x)
+{
+    size_t i;
+    int64_t v[SPARROW_N];
+    racc_ciphertext_t ct;
+
+    for (i = 0; i < SPARROW_N; i++) {
+        v[i] = diff_mod(&x, SPARROW_Q);
+    }
+    memset(&ct, 0, sizeof(ct));
+    diff_drbg(&x);
+    help_recvec(v, &ct);
+    memcpy(out, v, sizeof(v));
+    memcpy(out + sizeof(v), &ct, sizeof(ct));
+    return sizeof(v) + sizeof(ct);
+}
+
+static size_t dk_rec_vec(uint8_t *out, uint64_t x)
+{
+    size_t i;
+    int64_t v[SPARROW_N];
+    uint8_t b[CRYPTO_BYTES];
+    racc_ciphertext_t ct;
+
+    for (i = 0; i < SPARROW_N; i++) {
+        v[i] = diff_mod(&x, SPARROW_Q);
+    }
+    diff_bytes(&x, b, sizeof(b));
+    racc_decode_ct(&ct, b);
+    rec_vec(out, v, &ct);
+    return SPARROW_CTBITS / 4;
+}
+
+//  both fused output stages on one input; v + y spans (-q/8, q + q/8)
+
+#define DIFF_Y_MAX      (SPARROW_Q / 8 - 1)
+
+static size_t dk_intt_rec(uint8_t *out, uint64_t x)
+{
+    size_t i;
+    int64_t v[SPARROW_N], v1[SPARROW_N], y[SPARROW_N];
+    uint64_t r[REC_RAND_WORDS];
+    uint8_t h[SPARROW_CTBITS];
+
+    for (i = 0; i < SPARROW_N; i++) {
+        v[i] = diff_mod(&x, SPARROW_Q);
+        y[i] = diff_mod(&x, 2 * DIFF_Y_MAX + 1) - DIFF_Y_MAX;
+    }
+    for (i = 0; i < REC_RAND_WORDS; i++) {
+        r[i] = diff_rand(&x);
+    }
+    for (i = 0; i < SPARROW_CTBITS; i++) {
+        h[i] = diff_rand(&x) & 1;
+    }
+    polyr_copy(v1, v);
+    polyr_intt_rec(out, v1, y, h);
+    polyr_intt_help(out + SPARROW_CTBITS / 4, out + SPARROW_CTBITS / 2,
+                    v, y, r);
+    return SPARROW_CTBITS / 2 + SPARROW_CTBITS;
+}
+
+//  decode random bytes, encode the result again
+
+static size_t dk_serial_pk(uint8_t *out, uint64_t x)
+{
+    static racc_pk_t pk;
+    uint8_t b[CRYPTO_PUBLICKEYBYTES];
+
+    diff_bytes(&x, b, sizeof(b));
+    memset(&pk, 0, sizeof(pk));
+    racc_decode_pk(&pk, b);
+    memcpy(out, &pk, sizeof(pk));
+    racc_encode_pk(out + sizeof(pk), &pk);
+    return sizeof(pk) + CRYPTO_PUBLICKEYBYTES;
+}
+
+static size_t dk_serial_sk(uint8_t *out, uint64_t x)
+{
+    static racc_sk_t sk;
+    uint8_t b[CRYPTO_SECRETKEYBYTES];
+
+    diff_bytes(&x, b, sizeof(b));
+    memset(&sk, 0, sizeof(sk));
+    racc_decode_sk(&sk, b);
+    memcpy(out, &sk, sizeof(sk));
+    racc_encode_sk(out + sizeof(sk), &sk);
+    return sizeof(sk) + CRYPTO_SECRETKEYBYTES;
+}
+
+static size_t dk_serial_ct(uint8_t *out, uint64_t x)
+{
+    racc_ciphertext_t ct;
+    uint8_t b[CRYPTO_BYTES];
+
+    diff_bytes(&x, b, sizeof(b));
+    memset(&ct, 0, sizeof(ct));
+    racc_decode_ct(&ct, b);
+    memcpy(out, &ct, sizeof(ct));
+    racc_encode_ct(out + sizeof(ct), &ct);
+    return sizeof(ct) + CRYPTO_BYTES;
+}
+
+//  the api.h functions end to end: both key pairs, encaps, and decaps of
+//  the ciphertext and of a corrupted one (implicit rejection)
+
+static size_t dk_crypto_kem(uint8_t *out, uint64_t x)
+{
+    uint8_t *pkA = out, *skA = pkA + CRYPTO_PUBLICKEYBYTES;
+    uint8_t *pkB = skA + CRYPTO_SECRETKEYBYTES;
+    uint8_t *skB = pkB + CRYPTO_PUBLICKEYBYTES;
+    uint8_t *ct = skB + CRYPTO_SECRETKEYBYTES, *K = ct + CRYPTO_BYTES;
+    uint8_t *K1 = K + CRYPTO_SHAREDKEY, *K2 = K1 + CRYPTO_SHAREDKEY;
+
+    diff_drbg(&x);
+    crypto_sign_keypair(pkA, skA, 0);
+    crypto_sign_keypair(pkB, skB, 1);
+    crypto_encaps(K, ct, pkA, skB);
+    crypto_decaps(K1, ct, pkB, skA);
+    ct[diff_mod(&x, CRYPTO_BYTES)] ^= 1 << (diff_rand(&x) & 7);
+    K2[CRYPTO_SHAREDKEY] = crypto_decaps(K2, ct, pkB, skA);
+    return K2 + CRYPTO_SHAREDKEY + 1 - out;
+}
+
+//  "div": fraction of the inputs for the slower kernels
+
+typedef struct {
+    const char *name;
+    size_t (*run)(uint8_t *out, uint64_t x);
+    size_t div;
+} diff_kernel_t;
+
+static const diff_kernel_t diff_kernels[] = {
+    { "keccak_f1600",       dk_keccak,          1       },
+    { "keccak_f1600_x4",    dk_keccak_x4,       1       },
+    { "aes256_ctr",         dk_aes256_ctr,      1       },
+    { "xof_sample_q",       dk_xof_sample_q,    10      },
+    { "small_gauss_n",      dk_small_gauss,     100     },
+    { "large_gauss_ctbits", dk_large_gauss,     1000    },
+    { "gauss_stream",       dk_gauss_stream,    100     },
+    { "polyr_fntt",         dk_fntt,            1       },
+    { "polyr_intt",         dk_intt,            1       },
+    { "polyr_ntt_mul",      dk_ntt_mul,         1       },
+    { "polyr_small_mula",   dk_small_mula,      10      },
+    { "help_recvec",        dk_help_recvec,     10      },
+    { "rec_vec",            dk_rec_vec,         10      },
+    { "polyr_intt_rec",     dk_intt_rec,        1       },
+    { "serial_pk",          dk_serial_pk,       10      },
+    { "serial_sk",          dk_serial_sk,       10      },
+    { "serial_ct",          dk_serial_ct,       1       },
+    { "crypto_kem",         dk_crypto_kem,      1000    },
+};
+
+#define DIFF_KERNELS (sizeof(diff_kernels) / sizeof(diff_kernels[0]))
+
+//  input state of input "i" of kernel "k"
+
+static inline uint64_t diff_input(uint64_t seed, size_t k, size_t i)
+{
+    uint64_t x = seed ^ ((uint64_t) k << 56);
+
+    x ^= diff_rand(&x) + i;
+    return x;
+}
+
+//  Run inputs i0 <= i < i1 of kernel "k" at every level up to "max" and
+//  compare with the portable output. Returns 1 on the first divergence.
+
+static int diff_kernel(size_t k, uint64_t seed, size_t i0, size_t i1,
+                       int max, uint8_t *ref, uint8_t *out)
+{
+    const diff_kernel_t *dk = &diff_kernels[k];
+    size_t i, j, len, len_l;
+    uint64_t x;
+    int l;
+
+    for (i = i0; i < i1; i++) {
+        x = diff_input(seed, k, i);
+        plat_cpu_select(PLAT_CPU_PORTABLE);
+        len = dk->run(ref, x);
+        for (l = PLAT_CPU_PORTABLE + 1; l <= max; l++) {
+            plat_cpu_select(l);
+            len_l = dk->run(out, x);
+            if (len_l == len && memcmp(ref, out, len) == 0)
+                continue;
+            for (j = 0; j < len && ref[j] == out[j]; j++)
+                ;
+            printf("%-20s input %zu: %s differs from %s at byte %zu "
+                   "(of %zu): %02x != %02x\n", dk->name, i,
+                   plat_cpu_name(l), plat_cpu_name(PLAT_CPU_PORTABLE), j,
+                   len, j < len_l ? out[j] : 0, j < len ? ref[j] : 0);
+            printf("%-20s rerun: -s %llu -i %zu %s\n", "", (unsigned long long)
+                   seed, i, dk->name);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+//  xdiff [-n inputs] [-s seed] [-i input] [name]
+
+int main(int argc, char **argv)
+{
+    int opt, max, fail, l;
+    size_t k, n, m, i0, i1;
+    long idx;
+    uint64_t seed;
+    uint8_t *ref, *out;
+
+    n = DIFF_INPUTS;
+    seed = 0;
+    idx = -1;
+    while ((opt = getopt(argc, argv, "n:s:i:")) != -1) {
+        switch (opt) {
+            case 'n':   n = strtoul(optarg, NULL, 0);       break;
+            case 's':   seed = strtoull(optarg, NULL, 0);   break;
+            case 'i':   idx = strtol(optarg, NULL, 0);      break;
+            default:
+                fprintf(stderr, "usage: %s [-n inputs] [-s seed] [-i input] "
+                        "[name]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    max = plat_cpu_max();
+    printf("%s\tseed %llu\tbackends", CRYPTO_ALGNAME,
+           (unsigned long long) seed);
+    for (l = PLAT_CPU_PORTABLE; l <= max; l++) {
+        printf(" %s", plat_cpu_name(l));
+    }
+    printf("\n");
+    if (max == PLAT_CPU_PORTABLE)
+        printf("(only the portable backend on this CPU: nothing to compare)\n");
+
+    ref = malloc(DIFF_OUT_SZ);
+    out = malloc(DIFF_OUT_SZ);
+    fail = 0;
+    for (k = 0; k < DIFF_KERNELS; k++) {
+        if (optind < argc && strncmp(diff_kernels[k].name, argv[optind],
+                                     strlen(argv[optind])) != 0)
+            continue;
+#if defined(SPARROW_RNG_SYS) || defined(SPARROW_RNG_SHAKE)
+        //  randombytes() cannot be seeded in these builds
+        if (diff_kernels[k].run == dk_small_gauss ||
+            diff_kernels[k].run == dk_large_gauss ||
+            diff_kernels[k].run == dk_help_recvec ||
+            diff_kernels[k].run == dk_crypto_kem) {
+            printf("%-20s skipped (no seeded randombytes())\n",
+                   diff_kernels[k].name);
+            continue;
+        }
+#endif
+        if (idx >= 0) {
+            i0 = idx;
+            i1 = idx + 1;
+        } else {
+            i0 = 0;
+            i1 = (n + diff_kernels[k].div - 1) / diff_kernels[k].div;
+        }
+        m = i1 - i0;
+        if (diff_kernel(k, seed, i0, i1, max, ref, out) != 0) {
+            fail = 1;
+            continue;
+        }
+        printf("%-20s %10zu inputs\tok\n", diff_kernels[k].name, m);
+    }
+    free(out);
+    free(ref);
+    plat_cpu_init();
+
+    return fail;
+}
+
+// NIST_KAT
+#endif
@@ -0,0 +1,186 @@
+//  dudect_main.c
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Timing leakage test of decaps (in the style of dudect): cycle counts
+//      for valid vs. invalid ciphertexts, compared with Welch's t-test.
+
+#ifndef NIST_KAT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "plat_local.h"
+#include "nist_random.h"
+#include "sparrow_kem.h"
+
+//  ciphertexts per class, measurements per batch
+#define DUDECT_POOL     256
+#define DUDECT_BATCH    10000
+
+//  number of cropped tests: measurements below the percentile
+//  1 - 0.5^(10 * (i + 1) / DUDECT_CROPS), plus the uncropped one
+#define DUDECT_CROPS    10
+
+//  |t| thresholds: probably / definitely not constant time
+#define DUDECT_T_WARN   4.5
+#define DUDECT_T_LEAK   10.0
+
+//  running mean and variance (Welford) of one class
+
+typedef struct {
+    double n, mean, m2;
+} welch_t;
+
+static void welch_add(welch_t *w, double x)
+{
+    double d;
+
+    w->n += 1.0;
+    d = x - w->mean;
+    w->mean += d / w->n;
+    w->m2 += d * (x - w->mean);
+}
+
+//  Welch's t statistic of two classes
+
+static double welch_t_stat(const welch_t w[2])
+{
+    double v0, v1;
+
+    if (w[0].n < 2.0 || w[1].n < 2.0)
+        return 0.0;
+    v0 = w[0].m2 / (w[0].n - 1.0);
+    v1 = w[1].m2 / (w[1].n - 1.0);
+    return (w[0].mean - w[1].mean) / sqrt(v0 / w[0].n + v1 / w[1].n);
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+
+    return (x > y) - (x < y);
+}
+
+//  Measure "n" decapsulations of parameter set "kem"; return max |t|.
+
+static double dudect_kem(const sparrow_kem_t *kem, size_t n)
+{
+    size_t i, j, b, ct_sz = kem->ct_sz;
+    int k, k_max;
+    double t, t_max;
+    uint64_t cc;
+    uint64_t crop[DUDECT_CROPS];
+    welch_t w[DUDECT_CROPS + 1][2];
+
+    uint8_t *pk0 = malloc(2 * (kem->pk_sz + kem->sk_sz));
+    uint8_t *sk0 = pk0 + kem->pk_sz;
+    uint8_t *pk1 = sk0 + kem->sk_sz, *sk1 = pk1 + kem->pk_sz;
+    uint8_t *ct = malloc(2 * DUDECT_POOL * ct_sz);
+    uint8_t *key = malloc(kem->k_sz);
+    uint8_t *cls = malloc(DUDECT_BATCH);
+    uint16_t *idx = malloc(DUDECT_BATCH * sizeof(uint16_t));
+    uint64_t *x = malloc(DUDECT_BATCH * sizeof(uint64_t));
+
+    //  class 0: valid ciphertexts, class 1: the same with a random t
+    kem->keypair(pk0, sk0, 0);
+    kem->keypair(pk1, sk1, 1);
+    for (i = 0; i < DUDECT_POOL; i++) {
+        kem->encaps(key, ct + i * ct_sz, pk0, sk1);
+        memcpy(ct + (DUDECT_POOL + i) * ct_sz, ct + i * ct_sz, ct_sz);
+        randombytes(ct + (DUDECT_POOL + i + 1) * ct_sz - kem->t_sz,
+                    kem->t_sz);
+    }
+
+    memset(w, 0, sizeof(w));
+    memset(crop, 0, sizeof(crop));
+    t_max = 0.0;
+    k_max = 0;
+
+    //  batch 0 is a warm-up that sets the cropping thresholds
+    for (b = 0; b * DUDECT_BATCH < n + DUDECT_BATCH; b++) {
+
+        randombytes(cls, DUDECT_BATCH);
+        randombytes((uint8_t *) idx, DUDECT_BATCH * sizeof(uint16_t));
+        for (i = 0; i < DUDECT_BATCH; i++) {
+            cls[i] &= 1;
+            j = (cls[i] * DUDECT_POOL + idx[i] % DUDECT_POOL) * ct_sz;
+            cc = plat_get_cycle();
+            kem->decaps(key, ct + j, pk1, sk0);
+            x[i] = plat_get_cycle() - cc;
+        }
+
+        if (b == 0) {
+            qsort(x, DUDECT_BATCH, sizeof(uint64_t), cmp_u64);
+            for (k = 0; k < DUDECT_CROPS; k++) {
+                t = 1.0 - pow(0.5, 10.0 * (k + 1) / DUDECT_CROPS);
+                crop[k] = x[(size_t) (t * DUDECT_BATCH)];
+            }
+            continue;
+        }
+
+        for (i = 0; i < DUDECT_BATCH; i++) {
+            welch_add(&w[DUDECT_CROPS][cls[i]], (double) x[i]);
+            for (k = 0; k < DUDECT_CROPS; k++) {
+                if (x[i] < crop[k])
+                    welch_add(&w[k][cls[i]], (double) x[i]);
+            }
+        }
+    }
+
+    for (k = 0; k <= DUDECT_CROPS; k++) {
+        t = fabs(welch_t_stat(w[k]));
+        if (t > t_max) {
+            t_max = t;
+            k_max = k;
+        }
+    }
+
+    printf("%s\tdecaps valid %.0f invalid %.0f\tmean %8.1f / %8.1f cyc\t"
+           "max |t| = %6.2f (%s %d)\t%s\n", kem->name,
+           w[DUDECT_CROPS][0].n, w[DUDECT_CROPS][1].n,
+           w[DUDECT_CROPS][0].mean, w[DUDECT_CROPS][1].mean, t_max,
+           k_max < DUDECT_CROPS ? "crop" : "all", k_max,
+           t_max > DUDECT_T_LEAK ? "LEAK" :
+           t_max > DUDECT_T_WARN ? "probably leak" : "ok");
+
+    free(x);
+    free(idx);
+    free(cls);
+    free(key);
+    free(ct);
+    free(pk0);
+
+    return t_max;
+}
+
+//  xdudect [measurements] [parameter set]
+
+int main(int argc, char **argv)
+{
+    size_t i, n;
+    int fail;
+    uint8_t seed[48];
+    const sparrow_kem_t *kem;
+
+    n = argc > 1 ? strtoul(argv[1], NULL, 0) : 100000;
+
+    for (i = 0; i < 48; i++) {
+        seed[i] = i;
+    }
+    nist_randombytes_init(seed, NULL, 256);
+
+    fail = 0;
+    for (i = 0; i < sparrow_kem_count(); i++) {
+        kem = sparrow_kem_get(i);
+        if (argc > 2 && strcmp(argv[2], kem->name) != 0)
+            continue;
+        fail |= dudect_kem(kem, n) > DUDECT_T_LEAK;
+    }
+
+    return fail;
+}
+
+// NIST_KAT
+#endif
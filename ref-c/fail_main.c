@@ -0,0 +1,258 @@
+//  fail_main.c
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Decapsulation failure rate: many keygen + encaps + decaps trials in
+//      parallel worker processes with deterministic seeds, reported with a
+//      confidence interval (to compare with security/correctness/).
+
+#ifndef NIST_KAT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "plat_local.h"
+#include "plat_cpu.h"
+#include "nist_random.h"
+#include "sparrow_kem.h"
+
+//  default number of trials
+#define FAIL_TRIALS     1000000
+
+//  trials between reports of a worker, seconds between progress lines
+#define FAIL_CHUNK      1000
+#define FAIL_PROGRESS   10
+
+//  confidence level of the interval (two-sided normal quantile, 95%)
+#define FAIL_Z          1.959964
+
+//  report of a worker through the pipe (atomic: smaller than PIPE_BUF)
+
+typedef struct {
+    uint64_t done;                  //  trials since the last report
+    uint64_t fail;                  //  failures among them
+    uint64_t first;                 //  index of the first one, or ~0
+    uint32_t worker;
+} fail_rep_t;
+
+//  Run trials "i0 <= i < i1" of parameter set "kem" as worker "w", with new
+//  key pairs every "reuse" trials. The DRBG of a worker is seeded with
+//  (seed, w), so the results depend only on the seed and worker count.
+
+static void fail_worker(int fd, const sparrow_kem_t *kem, uint64_t seed,
+                        uint32_t w, uint64_t i0, uint64_t i1, uint64_t reuse)
+{
+    uint64_t i;
+    uint8_t entropy[48];
+    fail_rep_t rep;
+    uint8_t *pkA = malloc(2 * (kem->pk_sz + kem->sk_sz) + kem->ct_sz +
+                          2 * kem->k_sz);
+    uint8_t *skA, *pkB, *skB, *ct, *K, *K1;
+
+    //  the parent sees the missing trials and the exit status
+    if (pkA == NULL) {
+        perror("malloc");
+        _exit(1);
+    }
+    skA = pkA + kem->pk_sz;
+    pkB = skA + kem->sk_sz;
+    skB = pkB + kem->pk_sz;
+    ct = skB + kem->sk_sz;
+    K = ct + kem->ct_sz;
+    K1 = K + kem->k_sz;
+
+    memset(entropy, 0, sizeof(entropy));
+    memcpy(entropy, "fail", 4);
+    put64u_le(entropy + 8, seed);
+    put32u_le(entropy + 16, w);
+    nist_randombytes_init(entropy, NULL, 256);
+
+    memset(&rep, 0, sizeof(rep));
+    rep.first = ~0llu;
+    rep.worker = w;
+    for (i = i0; i < i1; i++) {
+        if ((i - i0) % reuse == 0) {
+            kem->keypair(pkA, skA, 0);
+            kem->keypair(pkB, skB, 1);
+        }
+        //  decaps only fails (-1) on a malformed key; a rejected
+        //  ciphertext shows as a different key
+        kem->encaps(K, ct, pkA, skB);
+        if (kem->decaps(K1, ct, pkB, skA) != 0 ||
+            memcmp(K, K1, kem->k_sz) != 0) {
+            if (rep.fail == 0)
+                rep.first = i;
+            rep.fail++;
+        }
+        rep.done++;
+        if (rep.done == FAIL_CHUNK || i + 1 == i1) {
+            if (write(fd, &rep, sizeof(rep)) != sizeof(rep))
+                break;
+            rep.done = 0;
+            rep.fail = 0;
+            rep.first = ~0llu;
+        }
+    }
+    free(pkA);
+}
+
+//  Wilson score interval of "f" failures in "n" trials
+
+static void fail_wilson(double *lo, double *hi, double f, double n)
+{
+    double p, z2, c, d;
+
+    p = f / n;
+    z2 = FAIL_Z * FAIL_Z;
+    c = (p + z2 / (2.0 * n)) / (1.0 + z2 / n);
+    d = FAIL_Z * sqrt(p * (1.0 - p) / n + z2 / (4.0 * n * n)) /
+        (1.0 + z2 / n);
+    *lo = f > 0 ? c - d : 0.0;
+    *hi = c + d;
+}
+
+//  a probability as "p (2^x)"
+
+static void fail_prob(const char *label, double p)
+{
+    if (p > 0.0)
+        printf("%s %.3e (2^%.2f)", label, p, log2(p));
+    else
+        printf("%s 0", label);
+}
+
+//  xfail [-n trials] [-j workers] [-s seed] [-r reuse] [-p predicted] [set]
+
+int main(int argc, char **argv)
+{
+    int opt, j, ret, st, bad, fd[2];
+    uint64_t n, reuse, seed, done, fail, first, i;
+    uint32_t first_w;
+    double pred, lo, hi;
+    time_t t0, tp;
+    fail_rep_t rep;
+    pid_t pid;
+    const sparrow_kem_t *kem;
+
+    n = FAIL_TRIALS;
+    j = sysconf(_SC_NPROCESSORS_ONLN);
+    seed = 0;
+    reuse = 1;
+    pred = 0.0;
+    while ((opt = getopt(argc, argv, "n:j:s:r:p:")) != -1) {
+        switch (opt) {
+            case 'n':   n = strtod(optarg, NULL);           break;
+            case 'j':   j = atoi(optarg);                   break;
+            case 's':   seed = strtoull(optarg, NULL, 0);   break;
+            case 'r':   reuse = strtoull(optarg, NULL, 0);  break;
+            case 'p':   pred = strtod(optarg, NULL);        break;
+            default:
+                fprintf(stderr, "usage: %s [-n trials] [-j workers] [-s seed] "
+                        "[-r reuse] [-p predicted] [set]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (j < 1)
+        j = 1;
+    if (reuse < 1)
+        reuse = 1;
+    kem = optind < argc ? sparrow_kem_by_name(argv[optind]) :
+                          sparrow_kem_get(0);
+    if (kem == NULL) {
+        fprintf(stderr, "%s: unknown parameter set %s\n", argv[0],
+                argv[optind]);
+        return 1;
+    }
+
+#if defined(SPARROW_RNG_BUF) || defined(SPARROW_RNG_SYS) || \
+    defined(SPARROW_RNG_SHAKE)
+    printf("(randombytes() is not the seeded DRBG: not reproducible)\n");
+#endif
+    printf("%s\t%s\t%llu trials, %d workers, seed %llu, keys every %llu\n",
+           kem->name, plat_cpu_name(plat_cpu_level()), (unsigned long long) n,
+           j, (unsigned long long) seed, (unsigned long long) reuse);
+    fflush(stdout);
+
+    if (pipe(fd) != 0) {
+        perror("pipe");
+        return 1;
+    }
+    for (i = 0; i < (uint64_t) j; i++) {
+        pid = fork();
+        if (pid < 0) {
+            perror("fork");
+            return 1;
+        }
+        if (pid == 0) {
+            close(fd[0]);
+            fail_worker(fd[1], kem, seed, i, n * i / j, n * (i + 1) / j,
+                        reuse);
+            close(fd[1]);
+            _exit(0);
+        }
+    }
+    close(fd[1]);
+
+    //  collect until every worker has closed its end
+    done = fail = 0;
+    first = ~0llu;
+    first_w = 0;
+    t0 = tp = time(NULL);
+    while (read(fd[0], &rep, sizeof(rep)) == sizeof(rep)) {
+        done += rep.done;
+        fail += rep.fail;
+        if (rep.fail > 0 && (rep.first < first ||
+                             (rep.first == first && rep.worker < first_w))) {
+            first = rep.first;
+            first_w = rep.worker;
+        }
+        if (time(NULL) - tp >= FAIL_PROGRESS) {
+            tp = time(NULL);
+            fprintf(stderr, "%llu / %llu trials, %llu failures, %.0f / s\n",
+                    (unsigned long long) done, (unsigned long long) n,
+                    (unsigned long long) fail,
+                    (double) done / (double) (tp - t0));
+        }
+    }
+    close(fd[0]);
+    bad = 0;
+    while (wait(&st) > 0) {
+        if (!WIFEXITED(st) || WEXITSTATUS(st) != 0)
+            bad++;
+    }
+
+    if (done == 0) {
+        printf("no trials\n");
+        return 1;
+    }
+    fail_wilson(&lo, &hi, (double) fail, (double) done);
+    printf("%llu failures in %llu trials", (unsigned long long) fail,
+           (unsigned long long) done);
+    if (fail > 0)
+        printf(" (first: worker %u, trial %llu)", (unsigned) first_w,
+               (unsigned long long) first);
+    printf("\n");
+    fail_prob("rate", (double) fail / (double) done);
+    printf("\n");
+    fail_prob("95% interval", lo);
+    fail_prob(" ..", hi);
+    printf("\n");
+    if (pred > 0.0) {
+        fail_prob("predicted", pred);
+        printf("\t%s\n", pred < lo ? "BELOW the interval" :
+                         pred > hi ? "ABOVE the interval" : "inside");
+    }
+    ret = done != n || bad != 0;
+    if (ret)
+        printf("(incomplete: %llu of %llu trials, %d workers failed)\n",
+               (unsigned long long) done, (unsigned long long) n, bad);
+
+    return ret;
+}
+
+// NIST_KAT
+#endif
@@ -4,7 +4,15 @@
 #include "nist_random.h"
 #include "sparrow_param.h"
 #include "gauss_sample.h"
+#include "polyr.h"
 #include "sha3_t.h"
+#include "keccakf1600.h"
+#include "plat_cpu.h"
+#include "ct_util.h"
+
+#ifdef PLAT_CPU_X64
+#include <immintrin.h>
+#endif
 
 
 static uint64_t small_gauss_table[] = {
@@ -4892,6 +4900,21 @@ static uint64_t large_gauss_table[] = {
     0, 0, 5077631217387171,
     0, 0, 2491931917279507};
 
+//  Number of table entries, each is a triple (w2, w1, w0), most significant
+//  word first.
+
+#define SMALL_GAUSS_SZ ((sizeof small_gauss_table) / (3 * sizeof(uint64_t)))
+#define LARGE_GAUSS_SZ ((sizeof large_gauss_table) / (3 * sizeof(uint64_t)))
+
+//  small samples have |z| <= SMALL_GAUSS_SZ; polyr_small_mula() takes them
+_Static_assert(SMALL_GAUSS_SZ <= POLYR_SMALL_MAX,
+               "small Gaussian samples exceed POLYR_SMALL_MAX");
+
+//  Samples are drawn in batches: random words are squeezed first, and
+//  then the (constant-time) table scans run through a dispatched kernel.
+
+#define GAUSS_BATCH 16
+
 /**
  * Sample a semi gaussian distribution of standard deviation 2^2.
  * v_i are random values in [0, 1<<63).
@@ -4922,48 +4945,6 @@ int small_gauss_sample(const uint64_t v0, const uint64_t v1, const uint64_t v2)
     return z;
 }
 
-void small_sample_gauss_vector(int64_t *vec, size_t size)
-{
-    uint8_t seed[SPARROW_SEC + 8];
-    size_t i;
-
-    //  --- 4.  sigma <- {0,1}^kappa
-    randombytes(seed + 8, SPARROW_SEC);
-
-    //  --- 5.  hdr_u := Ser8('g' || (0) || seed)
-    seed[0] = 'g'; //  ascii 117
-    memset(seed + 1, 0x00, 7);
-
-    //  absorb seed
-    sha3_t kec;
-    sha3_init(&kec, SHAKE256_RATE);
-    sha3_absorb(&kec, seed, sizeof(seed));
-    sha3_pad(&kec, SHAKE_PAD);
-
-    // sample Gaussian y
-    uint8_t buf[8];
-    uint64_t v0, v1, v2;
-    int s;
-    for (i = 0; i < size; i++)
-    {
-        sha3_squeeze(&kec, buf, sizeof(buf));
-        v0 = get64u_le(buf);
-        s = v0 & 1;
-        v0 >>= 1; // sample a sign
-
-        sha3_squeeze(&kec, buf, sizeof(buf));
-        v1 = get64u_le(buf) >> 1;
-
-        sha3_squeeze(&kec, buf, sizeof(buf));
-        v2 = get64u_le(buf) >> 1;
-
-        vec[i] = (2 * s - 1) * small_gauss_sample(v0, v1, v2);
-        // printf("small gauss %d\n", vec[i]);
-
-        // printf("%d\n", vec[i]);
-    }
-}
-
 /**
  * Sample a semi gaussian distribution of standard deviation 2^9.
  * v_i are random values in [0, 1<<63).
@@ -4992,10 +4973,190 @@ int large_gauss_sample(const uint64_t v0, const uint64_t v1, const uint64_t v2)
     return z;
 }
 
-void large_sample_gauss_vector(int64_t *vec, size_t size)
+//  === Table scan kernels
+//  For each of the "n" samples (v0[i], v1[i], v2[i]), z[i] is the number
+//  of the "tab_sz" entries in "tab" that are larger than the sample.
+
+static void gauss_scan_ref(int64_t *z, const uint64_t *v0, const uint64_t *v1,
+                           const uint64_t *v2, size_t n,
+                           const uint64_t *tab, size_t tab_sz)
+{
+    size_t i, u;
+    uint64_t cc;
+    int64_t c;
+
+    for (i = 0; i < n; i++) {
+        c = 0;
+        for (u = 0; u < 3 * tab_sz; u += 3) {
+            cc = (v0[i] - tab[u + 2]) >> 63;
+            cc = (v1[i] - tab[u + 1] - cc) >> 63;
+            cc = (v2[i] - tab[u + 0] - cc) >> 63;
+            c += (int64_t)cc;
+        }
+        z[i] = c;
+    }
+}
+
+#ifdef PLAT_CPU_X64
+
+//  AVX2: four samples per vector, up to four vectors share the broadcast
+//  table words.
+
+PLAT_TARGET_AVX2
+static inline __m256i gauss_cmp_avx2(__m256i z, __m256i v0, __m256i v1,
+                                     __m256i v2, __m256i w0, __m256i w1,
+                                     __m256i w2)
+{
+    __m256i cc;
+
+    cc = _mm256_srli_epi64(_mm256_sub_epi64(v0, w0), 63);
+    cc = _mm256_srli_epi64(_mm256_sub_epi64(_mm256_sub_epi64(v1, w1), cc), 63);
+    cc = _mm256_srli_epi64(_mm256_sub_epi64(_mm256_sub_epi64(v2, w2), cc), 63);
+
+    return _mm256_add_epi64(z, cc);
+}
+
+PLAT_TARGET_AVX2
+static void gauss_scan_avx2(int64_t *z, const uint64_t *v0, const uint64_t *v1,
+                            const uint64_t *v2, size_t n,
+                            const uint64_t *tab, size_t tab_sz)
+{
+    size_t i, u;
+    __m256i w0, w1, w2, z0, z1, z2, z3;
+    __m256i a0, a1, a2, b0, b1, b2, c0, c1, c2, d0, d1, d2;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+
+#define GAUSS_LD4(x, j) _mm256_loadu_si256((const __m256i *)(x + i + j))
+        a0 = GAUSS_LD4(v0, 0);  a1 = GAUSS_LD4(v1, 0);  a2 = GAUSS_LD4(v2, 0);
+        b0 = GAUSS_LD4(v0, 4);  b1 = GAUSS_LD4(v1, 4);  b2 = GAUSS_LD4(v2, 4);
+        c0 = GAUSS_LD4(v0, 8);  c1 = GAUSS_LD4(v1, 8);  c2 = GAUSS_LD4(v2, 8);
+        d0 = GAUSS_LD4(v0, 12); d1 = GAUSS_LD4(v1, 12); d2 = GAUSS_LD4(v2, 12);
+#undef GAUSS_LD4
+        z0 = z1 = z2 = z3 = _mm256_setzero_si256();
+
+        for (u = 0; u < 3 * tab_sz; u += 3) {
+            w0 = _mm256_set1_epi64x(tab[u + 2]);
+            w1 = _mm256_set1_epi64x(tab[u + 1]);
+            w2 = _mm256_set1_epi64x(tab[u + 0]);
+            z0 = gauss_cmp_avx2(z0, a0, a1, a2, w0, w1, w2);
+            z1 = gauss_cmp_avx2(z1, b0, b1, b2, w0, w1, w2);
+            z2 = gauss_cmp_avx2(z2, c0, c1, c2, w0, w1, w2);
+            z3 = gauss_cmp_avx2(z3, d0, d1, d2, w0, w1, w2);
+        }
+        _mm256_storeu_si256((__m256i *)(z + i), z0);
+        _mm256_storeu_si256((__m256i *)(z + i + 4), z1);
+        _mm256_storeu_si256((__m256i *)(z + i + 8), z2);
+        _mm256_storeu_si256((__m256i *)(z + i + 12), z3);
+    }
+
+    //  partial batch
+    gauss_scan_ref(z + i, v0 + i, v1 + i, v2 + i, n - i, tab, tab_sz);
+}
+
+//  AVX-512: eight samples per vector, two vectors per batch.
+
+PLAT_TARGET_AVX512
+static inline __m512i gauss_cmp_avx512(__m512i z, __m512i v0, __m512i v1,
+                                       __m512i v2, __m512i w0, __m512i w1,
+                                       __m512i w2)
+{
+    __m512i cc;
+
+    cc = _mm512_srli_epi64(_mm512_sub_epi64(v0, w0), 63);
+    cc = _mm512_srli_epi64(_mm512_sub_epi64(_mm512_sub_epi64(v1, w1), cc), 63);
+    cc = _mm512_srli_epi64(_mm512_sub_epi64(_mm512_sub_epi64(v2, w2), cc), 63);
+
+    return _mm512_add_epi64(z, cc);
+}
+
+PLAT_TARGET_AVX512
+static void gauss_scan_avx512(int64_t *z, const uint64_t *v0, const uint64_t *v1,
+                              const uint64_t *v2, size_t n,
+                              const uint64_t *tab, size_t tab_sz)
+{
+    size_t i, u;
+    __m512i w0, w1, w2, z0, z1;
+    __m512i a0, a1, a2, b0, b1, b2;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+
+        a0 = _mm512_loadu_si512((const void *)(v0 + i));
+        a1 = _mm512_loadu_si512((const void *)(v1 + i));
+        a2 = _mm512_loadu_si512((const void *)(v2 + i));
+        b0 = _mm512_loadu_si512((const void *)(v0 + i + 8));
+        b1 = _mm512_loadu_si512((const void *)(v1 + i + 8));
+        b2 = _mm512_loadu_si512((const void *)(v2 + i + 8));
+        z0 = z1 = _mm512_setzero_si512();
+
+        for (u = 0; u < 3 * tab_sz; u += 3) {
+            w0 = _mm512_set1_epi64(tab[u + 2]);
+            w1 = _mm512_set1_epi64(tab[u + 1]);
+            w2 = _mm512_set1_epi64(tab[u + 0]);
+            z0 = gauss_cmp_avx512(z0, a0, a1, a2, w0, w1, w2);
+            z1 = gauss_cmp_avx512(z1, b0, b1, b2, w0, w1, w2);
+        }
+        _mm512_storeu_si512((void *)(z + i), z0);
+        _mm512_storeu_si512((void *)(z + i + 8), z1);
+    }
+
+    //  partial batch
+    gauss_scan_ref(z + i, v0 + i, v1 + i, v2 + i, n - i, tab, tab_sz);
+}
+
+#else
+#define gauss_scan_avx2     gauss_scan_ref
+#define gauss_scan_avx512   gauss_scan_ref
+#endif
+
+static void (*const gauss_scan_tab[PLAT_CPU_LEVELS])
+            (int64_t *z, const uint64_t *v0, const uint64_t *v1,
+             const uint64_t *v2, size_t n,
+             const uint64_t *tab, size_t tab_sz) = {
+    gauss_scan_ref, gauss_scan_avx2, gauss_scan_avx512
+};
+
+//  Random words and temporaries of one batch (wiped by the caller).
+
+typedef struct {
+    uint64_t w[3 * GAUSS_BATCH];
+    uint64_t v0[GAUSS_BATCH], v1[GAUSS_BATCH], v2[GAUSS_BATCH];
+    int64_t z[GAUSS_BATCH], s[GAUSS_BATCH];
+} gauss_batch_t;
+
+//  Turn the 3 * "n" words in gb->w into "n" signed samples at "vec".
+
+static void gauss_batch(int64_t *vec, gauss_batch_t *gb, size_t n,
+                        const uint64_t *tab, size_t tab_sz)
+{
+    size_t j;
+
+    for (j = 0; j < n; j++) {
+        gb->v0[j] = gb->w[3 * j];
+        gb->s[j] = gb->v0[j] & 1;
+        gb->v0[j] >>= 1; // sample a sign
+
+        gb->v1[j] = gb->w[3 * j + 1] >> 1;
+        gb->v2[j] = gb->w[3 * j + 2] >> 1;
+    }
+
+    gauss_scan_tab[plat_cpu_level()](gb->z, gb->v0, gb->v1, gb->v2, n,
+                                     tab, tab_sz);
+
+    for (j = 0; j < n; j++) {
+        vec[j] = (2 * gb->s[j] - 1) * gb->z[j];
+    }
+}
+
+//  Sample "size" signed values with the cumulative table "tab".
+
+static void sample_gauss_vector(int64_t *vec, size_t size,
+                                const uint64_t *tab, size_t tab_sz)
 {
     uint8_t seed[SPARROW_SEC + 8];
-    size_t i;
+    size_t i, n;
+    sha3_t kec;
+    gauss_batch_t gb;
 
     //  --- 4.  sigma <- {0,1}^kappa
     randombytes(seed + 8, SPARROW_SEC);
@@ -5005,27 +5166,113 @@ void large_sample_gauss_vector(int64_t *vec, size_t size)
     memset(seed + 1, 0x00, 7);
 
     //  absorb seed
-    sha3_t kec;
     sha3_init(&kec, SHAKE256_RATE);
     sha3_absorb(&kec, seed, sizeof(seed));
     sha3_pad(&kec, SHAKE_PAD);
 
     // sample Gaussian y
-    uint8_t buf[8];
-    uint64_t v0, v1, v2;
-    int s;
-    for (i = 0; i < size; i++)
-    {
-        sha3_squeeze(&kec, buf, sizeof(buf));
-        v0 = get64u_le(buf);
-        s = v0 & 1; v0 >>= 1; // sample a sign
+    for (i = 0; i < size; i += n) {
+        n = size - i < GAUSS_BATCH ? size - i : GAUSS_BATCH;
 
-        sha3_squeeze(&kec, buf, sizeof(buf));
-        v1 = get64u_le(buf) >> 1;
+        //  three words per sample
+        sha3_squeeze_words(&kec, gb.w, 3 * n);
+        gauss_batch(vec + i, &gb, n, tab, tab_sz);
+    }
 
-        sha3_squeeze(&kec, buf, sizeof(buf));
-        v2 = get64u_le(buf) >> 1;
+    //  wipe the seed, XOF state, and the last batch
+    ct_memzero(seed, sizeof(seed));
+    sha3_clear(&kec);
+    ct_memzero(&gb, sizeof(gb));
+}
 
-        vec[i] = (2 * s - 1) * large_gauss_sample(v0, v1, v2);
+void small_sample_gauss_vector(int64_t *vec, size_t size)
+{
+    sample_gauss_vector(vec, size, small_gauss_table, SMALL_GAUSS_SZ);
+}
+
+void large_sample_gauss_vector(int64_t *vec, size_t size)
+{
+    sample_gauss_vector(vec, size, large_gauss_table, LARGE_GAUSS_SZ);
+}
+
+//  === Batched noise stream
+
+//  Seed stream "gs": instance j absorbs Ser8('g' || 'b' || j || (0) ||
+//  sigma) with a single sigma <- {0,1}^kappa, so that each instance is a
+//  plain SHAKE256 and none repeats the output of sample_gauss_vector().
+
+void gauss_stream_init(gauss_stream_t *gs)
+{
+    uint8_t seed[SPARROW_SEC + 8];
+    size_t i, j;
+    sha3_t kec;
+
+    randombytes(seed + 8, SPARROW_SEC);
+    seed[0] = 'g';
+    seed[1] = 'b';
+    memset(seed + 3, 0x00, 5);
+
+    for (j = 0; j < GAUSS_STREAM_WAYS; j++) {
+        seed[2] = j;
+        sha3_init(&kec, SHAKE256_RATE);
+        sha3_absorb(&kec, seed, sizeof(seed));
+        sha3_pad(&kec, SHAKE_PAD);
+        for (i = 0; i < 25; i++) {
+            gs->s[GAUSS_STREAM_WAYS * i + j] = kec.s[i];
+        }
+    }
+    //  the first request permutes
+    gs->i = GAUSS_STREAM_WAYS * GAUSS_STREAM_RATE;
+
+    ct_memzero(seed, sizeof(seed));
+    sha3_clear(&kec);
+}
+
+//  Next "n" words of stream "gs": one block of each instance in turn.
+
+static void gauss_stream_words(gauss_stream_t *gs, uint64_t *w, size_t n)
+{
+    size_t i, j, l;
+
+    while (n > 0) {
+        if (gs->i >= GAUSS_STREAM_WAYS * GAUSS_STREAM_RATE) {
+            keccak_f1600_x4(gs->s);
+            for (j = 0; j < GAUSS_STREAM_WAYS; j++) {
+                for (i = 0; i < GAUSS_STREAM_RATE; i++) {
+                    gs->w[GAUSS_STREAM_RATE * j + i] =
+                        gs->s[GAUSS_STREAM_WAYS * i + j];
+                }
+            }
+            gs->i = 0;
+        }
+        l = GAUSS_STREAM_WAYS * GAUSS_STREAM_RATE - gs->i;
+        if (l > n)
+            l = n;
+        memcpy(w, gs->w + gs->i, 8 * l);
+        w += l;
+        n -= l;
+        gs->i += l;
     }
 }
+
+//  The next "size" small Gaussian samples of stream "gs".
+
+void gauss_stream_small(gauss_stream_t *gs, int64_t *vec, size_t size)
+{
+    size_t i, n;
+    gauss_batch_t gb;
+
+    for (i = 0; i < size; i += n) {
+        n = size - i < GAUSS_BATCH ? size - i : GAUSS_BATCH;
+        gauss_stream_words(gs, gb.w, 3 * n);
+        gauss_batch(vec + i, &gb, n, small_gauss_table, SMALL_GAUSS_SZ);
+    }
+    ct_memzero(&gb, sizeof(gb));
+}
+
+//  Wipe stream "gs".
+
+void gauss_stream_clear(gauss_stream_t *gs)
+{
+    ct_memzero(gs, sizeof(gauss_stream_t));
+}
@@ -15,8 +15,21 @@
 #ifdef SPARROW_
 #define small_sample_gauss_vector SPARROW_(small_sample_gauss_vector)
 #define large_sample_gauss_vector SPARROW_(large_sample_gauss_vector)
+#define small_gauss_sample SPARROW_(small_gauss_sample)
+#define large_gauss_sample SPARROW_(large_gauss_sample)
+#define gauss_stream_init SPARROW_(gauss_stream_init)
+#define gauss_stream_small SPARROW_(gauss_stream_small)
+#define gauss_stream_clear SPARROW_(gauss_stream_clear)
 #endif
 
+//  Noise for many operations from one seed: four SHAKE256 instances
+//  (domain separated) squeezed together with keccak_f1600_x4().
+typedef struct {
+    uint64_t s[GAUSS_STREAM_WAYS * 25];     //  interleaved Keccak states
+    uint64_t w[GAUSS_STREAM_WAYS * GAUSS_STREAM_RATE];  //  squeezed words
+    size_t i;                               //  next unused word of w
+} gauss_stream_t;
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -24,6 +37,17 @@ extern "C"
     void small_sample_gauss_vector(int64_t *vec, size_t size);
     void large_sample_gauss_vector(int64_t *vec, size_t size);
 
+    //  Seed a stream with randombytes(); wipe it with gauss_stream_clear().
+    void gauss_stream_init(gauss_stream_t *gs);
+
+    //  The next "size" samples of the small distribution from stream "gs".
+    void gauss_stream_small(gauss_stream_t *gs, int64_t *vec, size_t size);
+    void gauss_stream_clear(gauss_stream_t *gs);
+
+    //  single samples; v_i are random values in [0, 1<<63)
+    int small_gauss_sample(const uint64_t v0, const uint64_t v1, const uint64_t v2);
+    int large_gauss_sample(const uint64_t v0, const uint64_t v1, const uint64_t v2);
+
 #ifdef __cplusplus
 }
 #endif
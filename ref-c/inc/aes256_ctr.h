@@ -0,0 +1,35 @@
+//  aes256_ctr.h
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === AES-256 counter mode keystream for the DRBG (nist_random.c).
+
+#ifndef _AES256_CTR_H_
+#define _AES256_CTR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "test_aes1kt.h"
+
+//  Expand a 256-bit key. The round key layout is that of aes1kt256_enc_key()
+//  (little-endian words, i.e. the standard byte order in memory).
+
+void aes256_ctr_key(uint32_t rk[AES256_RK_WORDS], const uint8_t key[32]);
+
+//  Encrypt "nb" successive counter blocks ctr + 1, .., ctr + nb into
+//  "out" (16 * nb bytes). The 128-bit big-endian "ctr" is advanced by nb.
+
+void aes256_ctr_blocks(uint8_t *out, uint8_t ctr[16], size_t nb,
+                       const uint32_t rk[AES256_RK_WORDS]);
+
+//  Name of the backend in use: "table", "aes-ni", or "vaes".
+
+const char *aes256_ctr_name(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+//  _AES256_CTR_H_
+#endif
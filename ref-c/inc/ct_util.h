@@ -19,6 +19,22 @@ void ct_cmov(uint8_t *r, const uint8_t *x, size_t len, uint8_t b);
 //  copy memory
 void ct_memcpy(void *dest, const void *src, size_t len);
 
+//  zeroize secret memory; unlike memset() never removed as a dead store
+void ct_memzero(void *p, size_t len);
+
+#ifdef SPARROW_CT_STATS
+
+//  ct_memzero() calls and bytes in this thread (statistics)
+typedef struct {
+    uint64_t calls;
+    uint64_t bytes;
+} ct_wipe_stat_t;
+
+ct_wipe_stat_t *ct_wipe_stat(void);
+
+//  SPARROW_CT_STATS
+#endif
+
 //  _CT_UTIL_H_
 #endif
 
@@ -20,6 +20,10 @@ void keccak_clear(uint64_t state[25]);
 //  FIPS 202 Keccak f1600 permutation, 24 rounds
 void keccak_f1600(uint64_t state[25]);
 
+//  four permutations of interleaved states: lane i of state j is
+//  state[4 * i + j]
+void keccak_f1600_x4(uint64_t state[4 * 25]);
+
 //  extract "rate" bytes from state
 void keccak_extract(uint64_t* state, uint8_t* data, size_t rate);
 
@@ -16,8 +16,9 @@ extern "C" {
 #include "../nist/rng.h"
 
 #else
-//  use the built-in version
-#include "test_aes1kt.h"
+//  use the built-in version (AES-NI / VAES when available)
+#include "aes256_ctr.h"
+#include "rng_buf.h"
 
 typedef struct {
     uint8_t key[32];
@@ -27,6 +28,12 @@ typedef struct {
 
 extern aes256_ctr_drbg_t aesdrbg_global_ctx;
 
+//  front end of randombytes(). Pass-through by default, so the output is
+//  that of the NIST generator; with -DSPARROW_RNG_BUF small requests are
+//  served from RNG_BUF_SZ chunks (faster, but a different byte stream).
+
+extern rng_buf_t nist_rng_buf;
+
 //  generic random interface
 
 void nist_randombytes_init(const uint8_t entropy_input[48],
@@ -39,7 +46,24 @@ int nist_randombytes(uint8_t *x, size_t xlen);
 
 void aes256ctr_xof_init(aes256_ctr_drbg_t *ctx, const uint8_t *input48);
 
+//  output "len" bytes and update; an rng_fill_t source for rng_buf_t
+
+int aes256ctr_xof(void *ctx, void *buf, size_t len);
+
+//  randombytes() backend, chosen at build time: the deterministic NIST
+//  DRBG above (default, for tests and KATs), or for production getrandom()
+//  per request (-DSPARROW_RNG_SYS) or a buffered, fork-safe SHAKE DRBG
+//  seeded by getrandom() (-DSPARROW_RNG_SHAKE). randombytes_buf() is the
+//  rng_buf_t front end in use, e.g. for request statistics.
+
+#if defined(SPARROW_RNG_SYS) || defined(SPARROW_RNG_SHAKE)
+#include "sys_random.h"
+#define randombytes(v, len) sys_randombytes(v, len)
+#define randombytes_buf()   sys_random_buf()
+#else
 #define randombytes(v, len) nist_randombytes(v, len)
+#define randombytes_buf()   (&nist_rng_buf)
+#endif
 
 //  NIST_KAT
 #endif
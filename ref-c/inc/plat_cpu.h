@@ -0,0 +1,79 @@
+//  plat_cpu.h
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Runtime CPU feature detection and kernel backend selection.
+
+#ifndef _PLAT_CPU_H_
+#define _PLAT_CPU_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "plat_local.h"
+
+//  SIMD backends are only compiled for x86-64 with a GCC-compatible compiler
+#if defined(PLAT_ARCH_X64) && (defined(__GNUC__) || defined(__clang__))
+#define PLAT_CPU_X64
+#define PLAT_TARGET_AVX2    __attribute__((target("avx2,bmi,bmi2")))
+#define PLAT_TARGET_AVX512  __attribute__((target( \
+    "avx512f,avx512dq,avx512bw,avx512vl,avx2,bmi,bmi2")))
+#define PLAT_TARGET_AESNI   __attribute__((target("aes,sse4.1")))
+#define PLAT_TARGET_VAES    __attribute__((target( \
+    "vaes,aes,avx512f,avx512dq,avx512bw,avx512vl,avx2,bmi,bmi2")))
+#endif
+
+//  Backend levels, in increasing order of capability. Each dispatched
+//  kernel has a table indexed by these; a missing backend points to the
+//  next lower one.
+
+#define PLAT_CPU_PORTABLE   0
+#define PLAT_CPU_AVX2       1
+#define PLAT_CPU_AVX512     2
+#define PLAT_CPU_LEVELS     3
+
+//  Environment variable that may force a (lower) backend, e.g. for
+//  benchmarking: SPARROW_CPU=portable|avx2|avx512.
+#define PLAT_CPU_ENV        "SPARROW_CPU"
+
+//  Optional extensions that are not implied by a level (plat_cpu_feat()).
+//  Kernels using them also honor the selected level: AES-NI is used from
+//  PLAT_CPU_AVX2 up and VAES at PLAT_CPU_AVX512.
+
+#define PLAT_CPU_F_AESNI    0x01
+#define PLAT_CPU_F_VAES     0x02
+
+//  currently selected level; negative before the first plat_cpu_init()
+extern int plat_cpu_sel;
+
+//  Detect the CPU, apply PLAT_CPU_ENV, and return the selected level.
+int plat_cpu_init(void);
+
+//  Highest level supported by this CPU (and operating system), cached.
+int plat_cpu_max(void);
+
+//  Select a backend level at runtime. Levels not supported by the CPU are
+//  clamped down. Returns the level actually selected.
+int plat_cpu_select(int level);
+
+//  Extension flags PLAT_CPU_F_* supported by this CPU (cached).
+int plat_cpu_feat(void);
+
+//  Human-readable backend name.
+const char *plat_cpu_name(int level);
+
+//  Current backend level; used by the dispatched kernels.
+
+static inline int plat_cpu_level(void)
+{
+    int sel = plat_cpu_sel;
+
+    return sel >= 0 ? sel : plat_cpu_init();
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+//  _PLAT_CPU_H_
+#endif
@@ -0,0 +1,57 @@
+//  plat_perf.h
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Hardware performance counters via Linux perf_event_open().
+
+#ifndef _PLAT_PERF_H_
+#define _PLAT_PERF_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "plat_local.h"
+
+//  Counted events (user mode of the calling thread only).
+
+#define PLAT_PERF_CYCLES    0       //  core clock cycles
+#define PLAT_PERF_INSTR     1       //  retired instructions
+#define PLAT_PERF_L1D_MISS  2       //  L1 data cache read misses
+#define PLAT_PERF_LLC_MISS  3       //  last level cache misses
+#define PLAT_PERF_BR_MISS   4       //  mispredicted branches
+#define PLAT_PERF_EVENTS    5
+
+//  One counter group; events the CPU does not support have fd -1 and
+//  read as zero.
+
+typedef struct {
+    int fd[PLAT_PERF_EVENTS];
+    int idx[PLAT_PERF_EVENTS];      //  position in the group read
+    int nr;                         //  counters in the group
+} plat_perf_t;
+
+//  Open the counters, stopped. Returns the number of counters (at least
+//  the cycle counter), or -1 if not available (no PMU, not Linux, or
+//  /proc/sys/kernel/perf_event_paranoid too high).
+int plat_perf_open(plat_perf_t *pp);
+
+//  Zero and start the counters. Returns 0 on success.
+int plat_perf_start(const plat_perf_t *pp);
+
+//  Stop the counters and read the counts since plat_perf_start() into
+//  "v". Returns 0 on success; -1 (and "v" zeroed) on failure or if the
+//  group was multiplexed with other events for part of the time.
+int plat_perf_stop(const plat_perf_t *pp, uint64_t v[PLAT_PERF_EVENTS]);
+
+//  Stop and close the counters.
+void plat_perf_close(plat_perf_t *pp);
+
+//  Short name of event "i", e.g. "llc-miss".
+const char *plat_perf_name(int i);
+
+#ifdef __cplusplus
+}
+#endif
+
+//  _PLAT_PERF_H_
+#endif
@@ -0,0 +1,67 @@
+//  plat_prof.h
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Optional per-stage cycle counters (build with -DSPARROW_PROF).
+
+#ifndef _PLAT_PROF_H_
+#define _PLAT_PROF_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include "plat_local.h"
+
+//  Stages of keygen / encaps / decaps.
+
+typedef enum {
+    PROF_DECODE,                    //  key and ciphertext decoding
+    PROF_ENCODE,                    //  key and ciphertext encoding
+    PROF_XOF,                       //  ExpandA: xof_sample_q()
+    PROF_NTT,                       //  polyr_fntt()
+    PROF_MULA,                      //  pointwise multiply-accumulate
+    PROF_INTT,                      //  polyr_intt(), fused output stage
+    PROF_GAUSS,                     //  Gaussian sampling
+    PROF_REC,                       //  reconciliation
+    PROF_HASH,                      //  K, t, and rejection key hashing
+    PROF_STAGES
+} prof_stage_t;
+
+//  Cycles and calls per stage, kept per thread.
+
+typedef struct {
+    uint64_t cyc[PROF_STAGES];
+    uint64_t calls[PROF_STAGES];
+} prof_tab_t;
+
+//  This thread's counters.
+prof_tab_t *prof_tab(void);
+
+//  Zero this thread's counters.
+void prof_reset(void);
+
+//  Print this thread's counters per operation ("ops" operations) to "f".
+void prof_report(FILE *f, const char *label, uint64_t ops);
+
+//  PROF(stage, statement): time "statement" into "stage". Without
+//  SPARROW_PROF just the statement, and prof_report() prints a note.
+
+#ifdef SPARROW_PROF
+#define PROF(stage, stmt) do {                          \
+        uint64_t prof_cc_ = plat_get_cycle();           \
+        stmt;                                           \
+        prof_cc_ = plat_get_cycle() - prof_cc_;         \
+        prof_tab()->cyc[stage] += prof_cc_;             \
+        prof_tab()->calls[stage]++;                     \
+    } while (0)
+#else
+#define PROF(stage, stmt) do { stmt; } while (0)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+//  _PLAT_PROF_H_
+#endif
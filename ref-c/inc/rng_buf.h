@@ -0,0 +1,50 @@
+//  rng_buf.h
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Buffered front end for random byte generators.
+
+#ifndef _RNG_BUF_H_
+#define _RNG_BUF_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "plat_local.h"
+
+//  Largest chunk pulled from the source at a time.
+#define RNG_BUF_SZ 1024
+
+//  Source of random bytes; same signature as aes256ctr_xof().
+typedef int (*rng_fill_t)(void *ctx, void *buf, size_t len);
+
+//  Small requests are served from "buf", which is refilled "sz" bytes at a
+//  time; requests of at least "sz" bytes go to the source directly. With
+//  sz = 0 every request is passed through (the byte stream of the source
+//  is then unchanged). Served bytes are wiped from the buffer.
+
+typedef struct {
+    rng_fill_t fill;                //  source
+    void *ctx;                      //  source context
+    size_t sz;                      //  chunk size, 0 .. RNG_BUF_SZ
+    size_t pos;                     //  next unread byte; sz when empty
+    uint64_t calls;                 //  requests served (statistics)
+    uint64_t bytes;                 //  bytes served (statistics)
+    uint8_t buf[RNG_BUF_SZ];
+} rng_buf_t;
+
+//  Initialize "rb" with source "fill(ctx, ..)" and chunk size "sz".
+void rng_buf_init(rng_buf_t *rb, rng_fill_t fill, void *ctx, size_t sz);
+
+//  Read "len" random bytes into "out". Returns nonzero on source failure.
+int rng_buf_read(rng_buf_t *rb, void *out, size_t len);
+
+//  Discard (and wipe) buffered bytes, e.g. after reseeding the source.
+void rng_buf_clear(rng_buf_t *rb);
+
+#ifdef __cplusplus
+}
+#endif
+
+//  _RNG_BUF_H_
+#endif
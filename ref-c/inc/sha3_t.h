@@ -47,6 +47,10 @@ void sha3_pad(sha3_t* kec, uint8_t p);
 
 void sha3_squeeze(sha3_t* kec, uint8_t* h, size_t h_sz);
 
+//  Squeeze "n" words (little-endian 8-byte output chunks) to "w".
+
+void sha3_squeeze_words(sha3_t* kec, uint64_t* w, size_t n);
+
 //  Clear sensitive information from the Keccak context "kec."
 
 void sha3_clear(sha3_t* kec);
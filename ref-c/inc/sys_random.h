@@ -0,0 +1,51 @@
+//  sys_random.h
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Operating system entropy and a fork-safe SHAKE DRBG for production.
+
+#ifndef _SYS_RANDOM_H_
+#define _SYS_RANDOM_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "plat_local.h"
+#include "rng_buf.h"
+
+//  Number of fills after which sys_drbg_fill() reseeds from the OS.
+#define SYS_DRBG_RESEED 1024
+
+//  SHAKE256 DRBG with fast key erasure: every fill derives a new key and
+//  the output from the old key, which is then overwritten.
+
+typedef struct {
+    uint8_t key[32];
+    uint64_t nfill;                 //  fills since the last reseed
+} sys_drbg_t;
+
+//  Read "len" bytes of OS entropy (getrandom()). An rng_fill_t source;
+//  "ctx" is not used. Returns nonzero on failure.
+int sys_getrandom(void *ctx, void *buf, size_t len);
+
+//  Seed "drbg" from the OS. Returns nonzero on failure.
+int sys_drbg_init(sys_drbg_t *drbg);
+
+//  Output "len" bytes from the sys_drbg_t "ctx" (an rng_fill_t source).
+int sys_drbg_fill(void *ctx, void *buf, size_t len);
+
+//  randombytes() of -DSPARROW_RNG_SYS (getrandom() per request) and
+//  -DSPARROW_RNG_SHAKE (buffered SHAKE DRBG) builds. State is per thread
+//  and is discarded in the child after fork(). Aborts if the OS fails to
+//  provide entropy.
+int sys_randombytes(uint8_t *x, size_t xlen);
+
+//  Front end of sys_randombytes() for the calling thread (statistics).
+rng_buf_t *sys_random_buf(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+//  _SYS_RANDOM_H_
+#endif
@@ -0,0 +1,375 @@
+//  kat_main.c
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Known answer tests of the KEM API: write PQCkemKAT_<set>.rsp files
+//      for every parameter set, or stream existing ones and check each
+//      vector bit for bit against this build (and backend, SPARROW_CPU).
+
+#ifndef NIST_KAT
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "plat_local.h"
+#include "plat_cpu.h"
+#include "nist_random.h"
+#include "sparrow_kem.h"
+
+//  default number of vectors per parameter set, as in the NIST generators
+#define KATNUM  100
+
+//  fields of one vector, in file order; the split KEM has two key pairs
+#define KAT_SEED    0
+#define KAT_PKA     1
+#define KAT_SKA     2
+#define KAT_PKB     3
+#define KAT_SKB     4
+#define KAT_CT      5
+#define KAT_SS      6
+#define KAT_FIELDS  7
+
+static const char *kat_names[KAT_FIELDS] = {
+    "seed", "pkA", "skA", "pkB", "skB", "ct", "ss"
+};
+
+//  one vector: buffers for each field and the length of each
+
+typedef struct {
+    const sparrow_kem_t *kem;
+    uint8_t *v[KAT_FIELDS];
+    size_t len[KAT_FIELDS];
+    uint8_t *ss1;
+} kat_vec_t;
+
+static void kat_init(kat_vec_t *kv, const sparrow_kem_t *kem)
+{
+    int i;
+    uint8_t *p;
+
+    kv->kem = kem;
+    kv->len[KAT_SEED] = 48;
+    kv->len[KAT_PKA] = kv->len[KAT_PKB] = kem->pk_sz;
+    kv->len[KAT_SKA] = kv->len[KAT_SKB] = kem->sk_sz;
+    kv->len[KAT_CT] = kem->ct_sz;
+    kv->len[KAT_SS] = kem->k_sz;
+
+    p = malloc(48 + 2 * (kem->pk_sz + kem->sk_sz) + kem->ct_sz +
+               2 * kem->k_sz);
+    for (i = 0; i < KAT_FIELDS; i++) {
+        kv->v[i] = p;
+        p += kv->len[i];
+    }
+    kv->ss1 = p;
+}
+
+static void kat_free(kat_vec_t *kv)
+{
+    free(kv->v[0]);
+}
+
+//  Compute the vector of kv->v[KAT_SEED]. Returns nonzero if a key does
+//  not decode or the key of decaps differs from that of encaps.
+
+static int kat_run(kat_vec_t *kv)
+{
+    const sparrow_kem_t *kem = kv->kem;
+    uint8_t **v = kv->v;
+    int r;
+
+    nist_randombytes_init(v[KAT_SEED], NULL, 256);
+    r = kem->keypair(v[KAT_PKA], v[KAT_SKA], 0);
+    r |= kem->keypair(v[KAT_PKB], v[KAT_SKB], 1);
+    r |= kem->encaps(v[KAT_SS], v[KAT_CT], v[KAT_PKA], v[KAT_SKB]);
+    r |= kem->decaps(kv->ss1, v[KAT_CT], v[KAT_PKB], v[KAT_SKA]);
+
+    return r != 0 || memcmp(v[KAT_SS], kv->ss1, kem->k_sz) != 0;
+}
+
+//  === Generator
+
+static void kat_hex(FILE *f, const char *label, const uint8_t *x, size_t len)
+{
+    size_t i;
+
+    fprintf(f, "%s = ", label);
+    for (i = 0; i < len; i++) {
+        fprintf(f, "%02X", x[i]);
+    }
+    fprintf(f, "\n");
+}
+
+//  Write "n" vectors of "kem" to PQCkemKAT_<name>.rsp. The seeds come from
+//  the DRBG seeded with 0, 1, .., 47 (a private instance; same bytes as
+//  randombytes() of the NIST generator).
+
+static int kat_gen(const sparrow_kem_t *kem, int n)
+{
+    int i, j, fail;
+    char fn[64];
+    uint8_t entropy[48];
+    aes256_ctr_drbg_t drbg;
+    kat_vec_t kv;
+    FILE *f;
+
+    snprintf(fn, sizeof(fn), "PQCkemKAT_%s.rsp", kem->name);
+    if ((f = fopen(fn, "w")) == NULL) {
+        perror(fn);
+        return 1;
+    }
+    for (i = 0; i < 48; i++) {
+        entropy[i] = i;
+    }
+    aes256ctr_xof_init(&drbg, entropy);
+    kat_init(&kv, kem);
+
+    fprintf(f, "# %s\n\n", kem->name);
+    fail = 0;
+    for (i = 0; i < n; i++) {
+        aes256ctr_xof(&drbg, kv.v[KAT_SEED], 48);
+        fail += kat_run(&kv);
+        fprintf(f, "count = %d\n", i);
+        for (j = 0; j < KAT_FIELDS; j++) {
+            kat_hex(f, kat_names[j], kv.v[j], kv.len[j]);
+        }
+        fprintf(f, "\n");
+    }
+    kat_free(&kv);
+    fclose(f);
+
+    printf("%s\t%s\t%d vectors\t%s\n", fn, plat_cpu_name(plat_cpu_level()),
+           n, fail ? "DECAPS FAIL" : "ok");
+    return fail != 0;
+}
+
+//  === Streaming verifier
+
+static int kat_unhex(uint8_t *x, size_t len, const char *s)
+{
+    size_t i;
+    int j, c, d;
+
+    for (i = 0; i < len; i++) {
+        d = 0;
+        for (j = 0; j < 2; j++) {
+            c = *s++;
+            if (c >= '0' && c <= '9')
+                c -= '0';
+            else if (c >= 'A' && c <= 'F')
+                c -= 'A' - 10;
+            else if (c >= 'a' && c <= 'f')
+                c -= 'a' - 10;
+            else
+                return -1;
+            d = (d << 4) | c;
+        }
+        x[i] = d;
+    }
+    //  trailing whitespace only
+    while (*s == ' ' || *s == '\t' || *s == '\r' || *s == '\n')
+        s++;
+    return *s == '\0' ? 0 : -1;
+}
+
+//  Recompute vector "count" from its seed and compare it with the fields
+//  read from the file (bits of "have"; those in "bad" did not parse).
+
+static int kat_check(const char *fn, kat_vec_t *kv, long count,
+                     unsigned have, unsigned bad)
+{
+    int i, fail;
+    uint8_t *ref;
+
+    if ((have & (1 << KAT_SEED)) == 0 || (bad & (1 << KAT_SEED)) != 0) {
+        fprintf(stderr, "%s: count = %ld: no seed\n", fn, count);
+        return 1;
+    }
+
+    //  the file's fields move aside, the computed ones take their place
+    ref = malloc(kv->len[KAT_SS] + kv->kem->ct_sz +
+                 2 * (kv->kem->pk_sz + kv->kem->sk_sz));
+    memcpy(ref, kv->v[KAT_PKA], kv->v[KAT_SS] + kv->len[KAT_SS] -
+                                kv->v[KAT_PKA]);
+    fail = kat_run(kv);
+    if (fail)
+        fprintf(stderr, "%s: count = %ld: decaps fails\n", fn, count);
+
+    for (i = KAT_PKA; i < KAT_FIELDS; i++) {
+        if ((have & (1 << i)) == 0) {
+            fprintf(stderr, "%s: count = %ld: no %s\n",
+                    fn, count, kat_names[i]);
+            fail = 1;
+        } else if ((bad & (1 << i)) != 0 ||
+            memcmp(kv->v[i], ref + (kv->v[i] - kv->v[KAT_PKA]),
+                   kv->len[i]) != 0) {
+            fprintf(stderr, "%s: count = %ld: %s differs\n",
+                    fn, count, kat_names[i]);
+            fail = 1;
+        }
+    }
+    free(ref);
+
+    return fail;
+}
+
+//  Check every vector of .rsp file "fn" (one line at a time). The
+//  parameter set is named in the "# <name>" header.
+
+static int kat_verify(const char *fn)
+{
+    FILE *f;
+    char *line, *s;
+    size_t line_sz;
+    ssize_t len;
+    long count, nv, nf;
+    unsigned have, bad;
+    int i;
+    const sparrow_kem_t *kem;
+    kat_vec_t kv;
+
+    if ((f = fopen(fn, "r")) == NULL) {
+        perror(fn);
+        return 1;
+    }
+    line = NULL;
+    line_sz = 0;
+    kem = NULL;
+    count = -1;
+    have = bad = 0;
+    nv = nf = 0;
+
+    while (1) {
+        len = getline(&line, &line_sz, f);
+
+        //  a blank line, the next count, or the end closes a vector
+        if (count >= 0 && (len < 0 || line[0] == '\n' || line[0] == '\r' ||
+                           strncmp(line, "count = ", 8) == 0)) {
+            nf += kat_check(fn, &kv, count, have, bad);
+            nv++;
+            count = -1;
+        }
+        if (len < 0)
+            break;
+
+        if (line[0] == '#' && kem == NULL) {
+            s = line + 1;
+            while (*s == ' ')
+                s++;
+            s[strcspn(s, " \t\r\n")] = '\0';
+            if ((kem = sparrow_kem_by_name(s)) == NULL) {
+                fprintf(stderr, "%s: parameter set %s not in this build\n",
+                        fn, s);
+                nf++;
+                break;
+            }
+            kat_init(&kv, kem);
+            continue;
+        }
+        if (strncmp(line, "count = ", 8) == 0) {
+            if (kem == NULL) {
+                fprintf(stderr, "%s: no \"# <name>\" header\n", fn);
+                nf++;
+                break;
+            }
+            count = strtol(line + 8, NULL, 10);
+            have = bad = 0;
+            continue;
+        }
+        if (count < 0)
+            continue;
+        for (i = 0; i < KAT_FIELDS; i++) {
+            len = strlen(kat_names[i]);
+            if (strncmp(line, kat_names[i], len) == 0 &&
+                strncmp(line + len, " = ", 3) == 0) {
+                have |= 1 << i;
+                if (kat_unhex(kv.v[i], kv.len[i], line + len + 3) != 0)
+                    bad |= 1 << i;
+                break;
+            }
+        }
+    }
+    free(line);
+    fclose(f);
+    if (kem == NULL) {
+        if (nf == 0)
+            fprintf(stderr, "%s: no \"# <name>\" header\n", fn);
+        return 1;
+    }
+    kat_free(&kv);
+
+    printf("%s\t%s (%s)\t%ld vectors\t", fn, kem->name,
+           plat_cpu_name(plat_cpu_level()), nv);
+    if (nf > 0 || nv == 0)
+        printf("FAIL (%ld)\n", nf);
+    else
+        printf("ok\n");
+
+    return nf > 0 || nv == 0;
+}
+
+//  xkat -g [-n count] [set ..]     write PQCkemKAT_<set>.rsp (default: all)
+//  xkat file.rsp ..                check the vectors in each file
+
+int main(int argc, char **argv)
+{
+    int opt, gen, n, fail, i;
+    size_t j;
+    const sparrow_kem_t *kem;
+
+    gen = 0;
+    n = KATNUM;
+    while ((opt = getopt(argc, argv, "gn:")) != -1) {
+        switch (opt) {
+            case 'g':   gen = 1;                        break;
+            case 'n':   n = atoi(optarg);               break;
+            default:
+                fprintf(stderr, "usage: %s -g [-n count] [set ..]\n"
+                        "       %s file.rsp ..\n", argv[0], argv[0]);
+                return 1;
+        }
+    }
+
+#if defined(SPARROW_RNG_BUF) || defined(SPARROW_RNG_SYS) || \
+    defined(SPARROW_RNG_SHAKE)
+    //  the vectors are those of the NIST DRBG, request by request
+    fprintf(stderr, "%s: KATs need the default randombytes() (no "
+            "SPARROW_RNG_BUF, _SYS or _SHAKE)\n", argv[0]);
+    return 1;
+#endif
+
+    fail = 0;
+    if (gen) {
+        if (optind >= argc) {
+            for (j = 0; j < sparrow_kem_count(); j++) {
+                fail |= kat_gen(sparrow_kem_get(j), n);
+            }
+        }
+        for (i = optind; i < argc; i++) {
+            if ((kem = sparrow_kem_by_name(argv[i])) == NULL) {
+                fprintf(stderr, "%s: unknown parameter set %s\n",
+                        argv[0], argv[i]);
+                return 1;
+            }
+            fail |= kat_gen(kem, n);
+        }
+    } else {
+        if (optind >= argc) {
+            fprintf(stderr, "%s: no .rsp files (generate with -g)\n",
+                    argv[0]);
+            return 1;
+        }
+        for (i = optind; i < argc; i++) {
+            fail |= kat_verify(argv[i]);
+        }
+    }
+
+    return fail;
+}
+
+// NIST_KAT
+#endif
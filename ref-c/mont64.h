@@ -9,30 +9,25 @@
 #include "plat_local.h"
 #include "sparrow_param.h"
 
-// file generated with scripts/gen_ring.py
+//  Montgomery constants. These depend on Q and N and are evaluated at
+//  compile time, so any NTT-friendly q (2n | q - 1) works.
 
-#if (SPARROW_N != 128 || SPARROW_Q != 260609l)
-#error "Unrecognized polynomial parameters N, Q"
+#if ((SPARROW_Q - 1) % (2 * SPARROW_N) != 0)
+#error "Q is not NTT-friendly for N: 2n does not divide q - 1"
 #endif
 
-/*
-    n   = 128
-    q1  = 260609
-    q2  = 1
-    q   = q1*q2
-    r   = 2^64 % q
-    rr  = r^2 % q
-    ni  = lift(rr * Mod(n,q)^-1)
-    qi  = lift(Mod(-q,2^64)^-1)
-*/
-
-//  Montgomery constants. These depend on Q and N
-#define MONT_R 125151L
-#define MONT_RR 171901L
-#define MONT_NI 7451L
-#define MONT_QI 2426873466807384575L
-
-// end generated
+//  r = 2^64 mod q,  rr = r^2 mod q
+#define MONT_R  ((int64_t)((((unsigned __int128)1) << 64) % SPARROW_Q))
+#define MONT_RR ((int64_t)(((unsigned __int128)MONT_R * MONT_R) % SPARROW_Q))
+
+//  ni = rr / n mod q, with 1/n = q - (q - 1)/n (mod q)
+#define MONT_NI ((int64_t)(((unsigned __int128)MONT_RR * \
+                 (SPARROW_Q - (SPARROW_Q - 1) / SPARROW_N)) % SPARROW_Q))
+
+//  qi = -1/q mod 2^64: five Newton steps from 1/q = q (mod 8)
+#define MONT_QI_(x)  ((x) * (2 - ((uint64_t)SPARROW_Q) * (x)))
+#define MONT_QI ((int64_t)(0 - MONT_QI_(MONT_QI_(MONT_QI_(MONT_QI_( \
+                 MONT_QI_((uint64_t)SPARROW_Q)))))))
 
 //  Addition and subtraction
 
@@ -5,118 +5,146 @@
 
 #include <stddef.h>
 #include <stdbool.h>
+#include <string.h>
 
 #include "polyr.h"
 #include "mont64.h"
+#include "plat_cpu.h"
+#include "sparrow_rec.h"
+
+#ifdef PLAT_CPU_X64
+#include <immintrin.h>
+#endif
 
 //  === Roots of unity constants
 
-// file generated with scripts/gen_ring.py
-
-static const int64_t sparrow_w_64[127] = {
-	         121164,          146817,          218404,
-	          27259,          186478,          162117,          169434,
-	         243759,          231077,           72852,           23347,
-	           1667,          214564,          138579,          240683,
-	         170236,           28814,          127897,           26868,
-	         162847,          216494,           91142,           63600,
-	           8967,          163946,          227655,          106837,
-	         140182,          240492,          159440,           43269,
-	          23795,          127388,           69726,           96716,
-	         253383,          176768,          110461,          238018,
-	         107586,           41969,           63147,          143834,
-	         113366,          168252,           47282,          117111,
-	         134036,          229844,          118146,           33720,
-	          86003,          121439,          189344,          118230,
-	         129395,           44898,          173042,          184715,
-	         231336,          197766,           70204,           31141,
-	         147708,           11664,          223999,          185309,
-	         157126,          218964,           37184,          201553,
-	         215109,          251236,           37418,          213068,
-	         208658,          206646,           78796,          260162,
-	         141853,          159005,          196109,          247322,
-	          12089,          126019,          172645,          184112,
-	         218317,          233133,          136824,           24016,
-	          57605,          254233,          248805,           85133,
-	         258357,          147562,           41350,           34579,
-	          19927,          260023,          106494,           75102,
-	         217822,           58423,          108650,          256930,
-	         176204,           52977,           13224,          102798,
-	          79675,          159748,           93993,          211692,
-	          69063,          107525,          209690,          183925,
-	          62503,          116598,           31112,           56446,
-	          94178,            5849,            7068,          180755,
-};
+//  Shoup pairs sparrow_wsh_64[] and sparrow_wsh_ni[] for this parameter
+//  set, generated at build time by tools/gen_ring.c into obj/<set>/.
 
-// end generated
+#include "ntt64_tab.h"
 
-//  Forward NTT (negacyclic -- evaluate polynomial at factors of x^n+1).
+//  The butterflies are lazy: all NTT values stay nonnegative and below
+//  2^31 between layers (see the bounds at each layer). The forward output
+//  is < (2 + 2 * lg n) * q; the inverse is reduced only in its last layer.
 
-void polyr_fntt(int64_t *v)
+#if ((SPARROW_Q << SPARROW_LGN) >= (1ll << 31))
+#error "Lazy NTT bounds exceed 31 bits for this (n, q)."
+#endif
+
+//  === Portable backend
+
+//  Shoup multiplication: r = y * w (mod q) in [0, 2q) for 0 <= y < 2^32,
+//  where wsh = { w, floor(w * 2^32 / q) }.
+
+static inline int64_t ntt_shoup(int64_t y, const int64_t *wsh)
+{
+    int64_t t, r;
+
+    XASSUME(y >= 0 && y < (1ll << 32));
+
+    t = (int64_t)(((uint64_t)y * (uint64_t)wsh[1]) >> SPARROW_SHOUP_K);
+    r = y * wsh[0] - t * SPARROW_Q;
+
+    XASSERT(r >= 0 && r < 2 * SPARROW_Q);
+
+    return r;
+}
+
+//  Forward NTT layers with "k" blocks of distance "j" down to j = 1.
+//  Block i of layer k uses twiddle sparrow_wsh_64[k - 1 + i]. The first
+//  layer (k = 1) takes |v[i]| < q and offsets it by q; each layer then
+//  maps [0, B) to [0, B + 2q).
+
+static inline void fntt_layers(int64_t *v, size_t k, size_t j)
 {
-    size_t i, j, k;
-    int64_t x, y, z;
+    size_t i;
+    int64_t x, y, c;
     int64_t *p0, *p1, *p2;
 
-    const int64_t *w = sparrow_w_64;
+    const int64_t (*w)[2] = &sparrow_wsh_64[k - 1];
 
-    for (k = 1, j = SPARROW_N >> 1; j > 0; k <<= 1, j >>= 1) {
+    for (; j > 0; k <<= 1, j >>= 1) {
 
+        c = k == 1 ? SPARROW_Q : 0;
         p0 = v;
         for (i = 0; i < k; i++) {
-            z = *w++;
             p1 = p0 + j;
             p2 = p1 + j;
 
             while (p1 < p2) {
-                x = *p0;
-                y = *p1;
-                y = mont64_mulq(y, z);
-                *p0++ = mont64_add(x, y);
-                *p1++ = mont64_sub(x, y);
+                x = *p0 + c;
+                y = ntt_shoup(*p1 + c, *w);
+                *p0++ = x + y;
+                *p1++ = x - y + 2 * SPARROW_Q;
             }
             p0 = p2;
+            w++;
         }
     }
 }
 
-//  Reverse NTT (negacyclic -- x^n+1), normalize by 1/(n*r).
+//  Reverse NTT layers with distance "j" up to (but not including) "j1".
+//  Block i of a layer with k blocks uses twiddle sparrow_wsh_64[2k - 2 - i].
+//  With input in [0, q), the input of the layer with distance j is in
+//  [0, j * q), so adding j * q keeps the difference nonnegative.
 
-void polyr_intt(int64_t *v)
+static inline void intt_layers(int64_t *v, size_t j, size_t j1)
 {
-    size_t i, j, k;
-    int64_t x, y, z;
+    size_t i, k;
+    int64_t x, y, c;
     int64_t *p0, *p1, *p2;
+    const int64_t (*w)[2];
 
-    const int64_t *w = &sparrow_w_64[SPARROW_N - 2];
-
-    for (j = 1, k = SPARROW_N >> 1; k > 0; j <<= 1, k >>= 1) {
+    for (k = SPARROW_N / (2 * j); j < j1; j <<= 1, k >>= 1) {
 
+        c = j * SPARROW_Q;
         p0 = v;
+        w = &sparrow_wsh_64[2 * k - 2];
 
         for (i = 0; i < k; i++) {
-            z = *w--;
             p1 = p0 + j;
             p2 = p1 + j;
 
             while (p1 < p2) {
                 x = *p0;
                 y = *p1;
-                *p0++ = mont64_add(x, y);
-                y = mont64_sub(y, x);
-                *p1++ = mont64_mulq(y, z);
+                *p0++ = x + y;
+                *p1++ = ntt_shoup(y - x + c, *w);
             }
             p0 = p2;
+            w--;
         }
     }
+}
 
-    //  normalization
-    polyr_ntt_smul(v, v, MONT_NI);
+//  Last reverse layer (distance n/2) merged with the normalization by
+//  2^64/n; output is reduced to [0, q).
+
+static inline void intt_final(int64_t *v)
+{
+    size_t i;
+    int64_t x, y;
+    const int64_t c = (SPARROW_N / 2) * SPARROW_Q;
+
+    for (i = 0; i < SPARROW_N / 2; i++) {
+        x = v[i];
+        y = v[i + SPARROW_N / 2];
+        v[i] = mont64_csub(ntt_shoup(x + y, sparrow_wsh_ni[0]), SPARROW_Q);
+        v[i + SPARROW_N / 2] =
+            mont64_csub(ntt_shoup(y - x + c, sparrow_wsh_ni[1]), SPARROW_Q);
+    }
+}
+
+//  Forward NTT (negacyclic -- evaluate polynomial at factors of x^n+1).
+
+static void polyr_fntt_ref(int64_t *v)
+{
+    fntt_layers(v, 1, SPARROW_N >> 1);
 }
 
 //  Scalar multiplication, Montgomery reduction.
 
-void polyr_ntt_smul(int64_t *r, const int64_t *a, int64_t c)
+static void polyr_ntt_smul_ref(int64_t *r, const int64_t *a, int64_t c)
 {
     size_t i;
 
@@ -125,9 +153,17 @@ void polyr_ntt_smul(int64_t *r, const int64_t *a, int64_t c)
     }
 }
 
+//  Reverse NTT (negacyclic -- x^n+1), normalize by 1/(n*r).
+
+static void polyr_intt_ref(int64_t *v)
+{
+    intt_layers(v, 1, SPARROW_N / 2);
+    intt_final(v);
+}
+
 //  Coefficient multiply:  r = a * b,  Montgomery reduction.
 
-void polyr_ntt_cmul(int64_t *r, const int64_t *a, const int64_t *b)
+static void polyr_ntt_cmul_ref(int64_t *r, const int64_t *a, const int64_t *b)
 {
     size_t i;
 
@@ -138,8 +174,8 @@ void polyr_ntt_cmul(int64_t *r, const int64_t *a, const int64_t *b)
 
 //  Coefficient multiply and add:  r = a * b + c, Montgomery reduction.
 
-void polyr_ntt_mula(int64_t *r, const int64_t *a, const int64_t *b,
-                    const int64_t *c)
+static void polyr_ntt_mula_ref(int64_t *r, const int64_t *a, const int64_t *b,
+                               const int64_t *c)
 {
     size_t i;
 
@@ -148,3 +184,902 @@ void polyr_ntt_mula(int64_t *r, const int64_t *a, const int64_t *b,
                            SPARROW_Q);
     }
 }
+
+//  === Fused output stage of encaps and decaps
+
+//  The vector backends take aligned groups of 8 coefficients; the first
+//  SPARROW_CTBITS coefficients are reconciled. All layers but the last are
+//  complete, and the last one computes only the outputs below
+//  SPARROW_CTBITS.
+
+#if (SPARROW_CTBITS % 8 != 0) || (SPARROW_CTBITS < SPARROW_N / 2) || \
+    (SPARROW_CTBITS > SPARROW_N)
+#error "SPARROW_CTBITS must be a multiple of 8 in [SPARROW_N/2, SPARROW_N]."
+#endif
+
+//  Reconcile coefficient i of v: with random words "r", first the hint
+//  ho[i] = help_rec(2v + r1 - r2) as in help_recvec(); then the key bits
+//  rec_element(2v, h[i]) into k as in rec_vec() (k starts zeroed).
+
+static inline void rec_coef(uint8_t *k, uint8_t *ho, const uint8_t *h,
+                            size_t i, int64_t v, const uint64_t *r)
+{
+    int64_t x;
+
+    if (r != NULL) {
+        x = (r[i / 32] >> (2 * (i % 32))) & 3;
+        ho[i] = help_rec(2 * v + (x & 1) - (x >> 1));
+    }
+    k[i / 4] |= rec_element(2 * v, h[i]) << (6 - 2 * (i % 4));
+}
+
+//  The last reverse layer as in intt_final(), then v += y (as in
+//  polyr_addq()) and the reconciliation of each output while it is in a
+//  register.
+
+static inline void intt_rec_final(uint8_t *k, uint8_t *ho, const uint8_t *h,
+                                  int64_t *v, const int64_t *y,
+                                  const uint64_t *r)
+{
+    size_t i;
+    int64_t x, z, t;
+    const int64_t c = (SPARROW_N / 2) * SPARROW_Q;
+
+    memset(k, 0, SPARROW_CTBITS / 4);
+    for (i = 0; i < SPARROW_N / 2 && i < SPARROW_CTBITS; i++) {
+        x = v[i];
+        z = v[i + SPARROW_N / 2];
+        t = mont64_csub(ntt_shoup(x + z, sparrow_wsh_ni[0]), SPARROW_Q);
+        rec_coef(k, ho, h, i, mont64_csub(t + y[i], SPARROW_Q), r);
+        if (i + SPARROW_N / 2 < SPARROW_CTBITS) {
+            t = mont64_csub(ntt_shoup(z - x + c, sparrow_wsh_ni[1]),
+                            SPARROW_Q);
+            rec_coef(k, ho, h, i + SPARROW_N / 2,
+                     mont64_csub(t + y[i + SPARROW_N / 2], SPARROW_Q), r);
+        }
+    }
+}
+
+static void polyr_intt_help_ref(uint8_t *k, uint8_t *h, int64_t *v,
+                                const int64_t *y, const uint64_t *r)
+{
+    intt_layers(v, 1, SPARROW_N / 2);
+    intt_rec_final(k, h, h, v, y, r);
+}
+
+static void polyr_intt_rec_ref(uint8_t *k, int64_t *v, const int64_t *y,
+                               const uint8_t *h)
+{
+    intt_layers(v, 1, SPARROW_N / 2);
+    intt_rec_final(k, NULL, h, v, y, NULL);
+}
+
+#ifdef PLAT_CPU_X64
+
+//  === AVX2 backend
+
+//  The vector Montgomery multiplication is bit-exact with mont64_mulq().
+//  With r = x * QI (mod 2^64) split as r = rh * 2^32 + rl, we have
+//  (x + r * q) / 2^64 = ((x + rl * q) / 2^32 + rh * q) / 2^32, where all
+//  divisions are exact and every term fits in 64 bits. The inputs must
+//  satisfy |x|, |y| < 2^31, which holds for all NTT-domain values here.
+
+//  arithmetic shift right by 32 of 64-bit lanes
+
+PLAT_TARGET_AVX2
+static inline __m256i mont64_srai32_avx2(__m256i x)
+{
+    return _mm256_blend_epi32(_mm256_srli_epi64(x, 32),
+                              _mm256_srai_epi32(x, 31), 0xAA);
+}
+
+PLAT_TARGET_AVX2
+static inline __m256i mont64_mulq_avx2(__m256i x, __m256i y)
+{
+    const __m256i q = _mm256_set1_epi64x(SPARROW_Q);
+    const __m256i qi_lo = _mm256_set1_epi64x(MONT_QI & 0xFFFFFFFF);
+    const __m256i qi_hi = _mm256_set1_epi64x(((uint64_t)MONT_QI) >> 32);
+    __m256i p, r, t;
+
+    //  p = x * y,  r = p * QI (mod 2^64)
+    p = _mm256_mul_epi32(x, y);
+    t = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(p, 32), qi_lo),
+                         _mm256_mul_epu32(p, qi_hi));
+    r = _mm256_add_epi64(_mm256_mul_epu32(p, qi_lo),
+                         _mm256_slli_epi64(t, 32));
+
+    //  (p + r * q) >> 64
+    p = _mm256_add_epi64(p, _mm256_mul_epu32(r, q));
+    p = _mm256_add_epi64(mont64_srai32_avx2(p),
+                         _mm256_mul_epi32(_mm256_srli_epi64(r, 32), q));
+
+    return mont64_srai32_avx2(p);
+}
+
+//  conditionally add m if x is negative
+
+PLAT_TARGET_AVX2
+static inline __m256i mont64_cadd_avx2(__m256i x, __m256i m)
+{
+    return _mm256_add_epi64(x,
+        _mm256_and_si256(_mm256_cmpgt_epi64(_mm256_setzero_si256(), x), m));
+}
+
+//  conditionally subtract m if x >= m
+
+PLAT_TARGET_AVX2
+static inline __m256i mont64_csub_avx2(__m256i x, __m256i m)
+{
+    return mont64_cadd_avx2(_mm256_sub_epi64(x, m), m);
+}
+
+//  Shoup multiplication, bit-exact with ntt_shoup(); "w" and "wp" hold
+//  the pair { w, floor(w * 2^32 / q) } in each lane.
+
+PLAT_TARGET_AVX2
+static inline __m256i ntt_shoup_avx2(__m256i y, __m256i w, __m256i wp)
+{
+    const __m256i q = _mm256_set1_epi64x(SPARROW_Q);
+    __m256i t;
+
+    t = _mm256_srli_epi64(_mm256_mul_epu32(y, wp), SPARROW_SHOUP_K);
+    return _mm256_sub_epi64(_mm256_mul_epu32(y, w), _mm256_mul_epu32(t, q));
+}
+
+//  one forward layer with "k" blocks of distance "j" >= 4
+
+PLAT_TARGET_AVX2
+static inline void fntt_layer_avx2(int64_t *v, size_t k, size_t j)
+{
+    size_t i, l;
+    __m256i x, y, z, zp;
+    int64_t *p0, *p1;
+    const int64_t (*w)[2] = &sparrow_wsh_64[k - 1];
+    const __m256i c = _mm256_set1_epi64x(k == 1 ? SPARROW_Q : 0);
+    const __m256i q2 = _mm256_set1_epi64x(2 * SPARROW_Q);
+
+    p0 = v;
+    for (i = 0; i < k; i++) {
+        z = _mm256_set1_epi64x(w[i][0]);
+        zp = _mm256_set1_epi64x(w[i][1]);
+        p1 = p0 + j;
+
+        for (l = 0; l < j; l += 4) {
+            x = _mm256_loadu_si256((const __m256i *)(p0 + l));
+            y = _mm256_loadu_si256((const __m256i *)(p1 + l));
+            x = _mm256_add_epi64(x, c);
+            y = ntt_shoup_avx2(_mm256_add_epi64(y, c), z, zp);
+            _mm256_storeu_si256((__m256i *)(p0 + l), _mm256_add_epi64(x, y));
+            x = _mm256_add_epi64(x, q2);
+            _mm256_storeu_si256((__m256i *)(p1 + l), _mm256_sub_epi64(x, y));
+        }
+        p0 = p1 + j;
+    }
+}
+
+//  one reverse layer with "k" blocks of distance "j" >= 4
+
+PLAT_TARGET_AVX2
+static inline void intt_layer_avx2(int64_t *v, size_t k, size_t j)
+{
+    size_t i, l;
+    __m256i x, y, z, zp;
+    int64_t *p0, *p1;
+    const int64_t (*w)[2] = &sparrow_wsh_64[2 * k - 2];
+    const __m256i c = _mm256_set1_epi64x(j * SPARROW_Q);
+
+    p0 = v;
+    for (i = 0; i < k; i++) {
+        z = _mm256_set1_epi64x(w[-i][0]);
+        zp = _mm256_set1_epi64x(w[-i][1]);
+        p1 = p0 + j;
+
+        for (l = 0; l < j; l += 4) {
+            x = _mm256_loadu_si256((const __m256i *)(p0 + l));
+            y = _mm256_loadu_si256((const __m256i *)(p1 + l));
+            _mm256_storeu_si256((__m256i *)(p0 + l), _mm256_add_epi64(x, y));
+            y = _mm256_add_epi64(_mm256_sub_epi64(y, x), c);
+            y = ntt_shoup_avx2(y, z, zp);
+            _mm256_storeu_si256((__m256i *)(p1 + l), y);
+        }
+        p0 = p1 + j;
+    }
+}
+
+//  last reverse layer with the normalization, see intt_final()
+
+PLAT_TARGET_AVX2
+static inline void intt_final_avx2(int64_t *v)
+{
+    size_t i;
+    __m256i x, y;
+    int64_t *p1 = v + SPARROW_N / 2;
+    const __m256i q = _mm256_set1_epi64x(SPARROW_Q);
+    const __m256i c = _mm256_set1_epi64x((SPARROW_N / 2) * SPARROW_Q);
+    const __m256i s = _mm256_set1_epi64x(sparrow_wsh_ni[0][0]);
+    const __m256i sp = _mm256_set1_epi64x(sparrow_wsh_ni[0][1]);
+    const __m256i ws = _mm256_set1_epi64x(sparrow_wsh_ni[1][0]);
+    const __m256i wsp = _mm256_set1_epi64x(sparrow_wsh_ni[1][1]);
+
+    for (i = 0; i < SPARROW_N / 2; i += 4) {
+        x = _mm256_loadu_si256((const __m256i *)(v + i));
+        y = _mm256_loadu_si256((const __m256i *)(p1 + i));
+        _mm256_storeu_si256((__m256i *)(v + i), mont64_csub_avx2(
+            ntt_shoup_avx2(_mm256_add_epi64(x, y), s, sp), q));
+        y = _mm256_add_epi64(_mm256_sub_epi64(y, x), c);
+        _mm256_storeu_si256((__m256i *)(p1 + i), mont64_csub_avx2(
+            ntt_shoup_avx2(y, ws, wsp), q));
+    }
+}
+
+PLAT_TARGET_AVX2
+static void polyr_fntt_avx2(int64_t *v)
+{
+    size_t k, j;
+
+    for (k = 1, j = SPARROW_N >> 1; j >= 4; k <<= 1, j >>= 1) {
+        fntt_layer_avx2(v, k, j);
+    }
+    fntt_layers(v, k, j);
+}
+
+PLAT_TARGET_AVX2
+static void polyr_ntt_smul_avx2(int64_t *r, const int64_t *a, int64_t c)
+{
+    size_t i;
+    __m256i x;
+    const __m256i q = _mm256_set1_epi64x(SPARROW_Q);
+    const __m256i y = _mm256_set1_epi64x(c);
+
+    for (i = 0; i < SPARROW_N; i += 4) {
+        x = _mm256_loadu_si256((const __m256i *)(a + i));
+        x = mont64_cadd_avx2(mont64_mulq_avx2(x, y), q);
+        _mm256_storeu_si256((__m256i *)(r + i), x);
+    }
+}
+
+//  all reverse layers but the last
+
+PLAT_TARGET_AVX2
+static inline void intt_lazy_avx2(int64_t *v)
+{
+    size_t k, j;
+
+    intt_layers(v, 1, 4);
+    for (j = 4, k = SPARROW_N >> 3; k > 1; j <<= 1, k >>= 1) {
+        intt_layer_avx2(v, k, j);
+    }
+}
+
+PLAT_TARGET_AVX2
+static void polyr_intt_avx2(int64_t *v)
+{
+    intt_lazy_avx2(v);
+    intt_final_avx2(v);
+}
+
+PLAT_TARGET_AVX2
+static void polyr_ntt_cmul_avx2(int64_t *r, const int64_t *a, const int64_t *b)
+{
+    size_t i;
+    __m256i x, y;
+    const __m256i q = _mm256_set1_epi64x(SPARROW_Q);
+
+    for (i = 0; i < SPARROW_N; i += 4) {
+        x = _mm256_loadu_si256((const __m256i *)(a + i));
+        y = _mm256_loadu_si256((const __m256i *)(b + i));
+        x = mont64_cadd_avx2(mont64_mulq_avx2(x, y), q);
+        _mm256_storeu_si256((__m256i *)(r + i), x);
+    }
+}
+
+PLAT_TARGET_AVX2
+static void polyr_ntt_mula_avx2(int64_t *r, const int64_t *a, const int64_t *b,
+                                const int64_t *c)
+{
+    size_t i;
+    __m256i x, y;
+    const __m256i q = _mm256_set1_epi64x(SPARROW_Q);
+
+    for (i = 0; i < SPARROW_N; i += 4) {
+        x = _mm256_loadu_si256((const __m256i *)(a + i));
+        y = _mm256_loadu_si256((const __m256i *)(b + i));
+        x = mont64_cadd_avx2(mont64_mulq_avx2(x, y), q);
+        y = _mm256_loadu_si256((const __m256i *)(c + i));
+        x = mont64_csub_avx2(_mm256_add_epi64(x, y), q);
+        _mm256_storeu_si256((__m256i *)(r + i), x);
+    }
+}
+
+//  Fused output stage. One comparison per cutoff c_j = REC_CUTOFF(j) finds
+//  the region j of w (c_j <= w < c_{j+1}, j = 0 also below c_1): its
+//  parity is help_rec(w), and c_j - 1, c_{j+1} are the two candidates of
+//  closest_v(). Bit-exact with help_rec() and rec_element() for inputs
+//  above -q/4 (v[i] + y[i] > -q/8).
+
+PLAT_TARGET_AVX2
+static inline __m256i rec_parity_avx2(__m256i x)
+{
+    size_t j;
+    __m256i p = _mm256_setzero_si256();
+
+    for (j = 1; j < REC_CUTOFFS - 1; j++) {
+        p = _mm256_xor_si256(p, _mm256_cmpgt_epi64(x,
+                _mm256_set1_epi64x(REC_CUTOFF(j) - 1)));
+    }
+    return _mm256_and_si256(p, _mm256_set1_epi64x(1));
+}
+
+//  rec_element(w, b): w if its parity is b, else the closer candidate
+//  (the lower one on a tie), reduced mod 2q and rounded to B bits
+
+PLAT_TARGET_AVX2
+static inline __m256i rec_key_avx2(__m256i w, __m256i b)
+{
+    size_t j;
+    __m256i m, p, lo, hi, x;
+    const __m256i one = _mm256_set1_epi64x(1);
+    const __m256i q2 = _mm256_set1_epi64x(2 * SPARROW_Q);
+
+    p = lo = _mm256_setzero_si256();
+    hi = _mm256_set1_epi64x(REC_CUTOFF(1));
+    for (j = 1; j < REC_CUTOFFS - 1; j++) {
+        m = _mm256_cmpgt_epi64(w, _mm256_set1_epi64x(REC_CUTOFF(j) - 1));
+        p = _mm256_xor_si256(p, m);
+        lo = _mm256_add_epi64(lo, _mm256_and_si256(m,
+                _mm256_set1_epi64x(REC_CUTOFF(j) - REC_CUTOFF(j - 1))));
+        hi = _mm256_add_epi64(hi, _mm256_and_si256(m,
+                _mm256_set1_epi64x(REC_CUTOFF(j + 1) - REC_CUTOFF(j))));
+    }
+
+    //  down when w - (c_j - 1) <= c_{j+1} - w
+    m = _mm256_cmpgt_epi64(_mm256_add_epi64(lo, hi), _mm256_add_epi64(w, w));
+    x = _mm256_blendv_epi8(hi, _mm256_sub_epi64(lo, one), m);
+    m = _mm256_cmpeq_epi64(_mm256_and_si256(p, one), b);
+    x = _mm256_blendv_epi8(x, w, m);
+    x = mont64_csub_avx2(mont64_cadd_avx2(x, q2), q2);
+
+    //  ((x << (B - 1)) + q/2) / q for 0 <= x < 2q, mod 4
+    x = _mm256_add_epi64(_mm256_slli_epi64(x, SPARROW_B - 1),
+                         _mm256_set1_epi64x(SPARROW_Q / 2));
+    m = _mm256_setzero_si256();
+    for (j = 1; j <= 4; j++) {
+        m = _mm256_sub_epi64(m, _mm256_cmpgt_epi64(x,
+                _mm256_set1_epi64x(j * SPARROW_Q - 1)));
+    }
+    return _mm256_and_si256(m, _mm256_set1_epi64x(3));
+}
+
+//  hints (with "r") and key bits of coefficients i .. i + 3, see rec_coef()
+
+PLAT_TARGET_AVX2
+static inline void rec_group_avx2(uint8_t *k, uint8_t *ho, const uint8_t *h,
+                                  size_t i, __m256i v, const uint64_t *r)
+{
+    uint32_t m;
+    __m256i w, x;
+    const __m256i one = _mm256_set1_epi64x(1);
+
+    w = _mm256_add_epi64(v, v);
+    if (r != NULL) {
+        x = _mm256_srlv_epi64(_mm256_set1_epi64x(r[i / 32] >> (2 * (i % 32))),
+                              _mm256_setr_epi64x(0, 2, 4, 6));
+        x = _mm256_sub_epi64(_mm256_and_si256(x, one),
+                             _mm256_and_si256(_mm256_srli_epi64(x, 1), one));
+        x = rec_parity_avx2(_mm256_add_epi64(w, x));
+
+        //  four lane bits to four bytes
+        m = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_slli_epi64(x, 63)));
+        m = (m * 0x00204081) & 0x01010101;
+        memcpy(ho + i, &m, 4);
+    }
+    memcpy(&m, h + i, 4);
+    x = rec_key_avx2(w, _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(m)));
+    x = _mm256_sllv_epi64(x, _mm256_setr_epi64x(6, 4, 2, 0));
+    x = _mm256_or_si256(x, _mm256_srli_si256(x, 8));
+    k[i / 4] = _mm256_extract_epi8(x, 0) | _mm256_extract_epi8(x, 16);
+}
+
+//  last reverse layer, v += y and reconciliation, see intt_rec_final()
+
+PLAT_TARGET_AVX2
+static inline void intt_rec_final_avx2(uint8_t *k, uint8_t *ho,
+                                       const uint8_t *h, int64_t *v,
+                                       const int64_t *y, const uint64_t *r)
+{
+    size_t i;
+    __m256i x, z, t;
+    int64_t *p1 = v + SPARROW_N / 2;
+    const __m256i q = _mm256_set1_epi64x(SPARROW_Q);
+    const __m256i c = _mm256_set1_epi64x((SPARROW_N / 2) * SPARROW_Q);
+    const __m256i s = _mm256_set1_epi64x(sparrow_wsh_ni[0][0]);
+    const __m256i sp = _mm256_set1_epi64x(sparrow_wsh_ni[0][1]);
+    const __m256i ws = _mm256_set1_epi64x(sparrow_wsh_ni[1][0]);
+    const __m256i wsp = _mm256_set1_epi64x(sparrow_wsh_ni[1][1]);
+
+    for (i = 0; i < SPARROW_N / 2 && i < SPARROW_CTBITS; i += 4) {
+        x = _mm256_loadu_si256((const __m256i *)(v + i));
+        z = _mm256_loadu_si256((const __m256i *)(p1 + i));
+        t = mont64_csub_avx2(ntt_shoup_avx2(_mm256_add_epi64(x, z), s, sp), q);
+        t = _mm256_add_epi64(t, _mm256_loadu_si256((const __m256i *)(y + i)));
+        rec_group_avx2(k, ho, h, i, mont64_csub_avx2(t, q), r);
+        if (i + SPARROW_N / 2 < SPARROW_CTBITS) {
+            t = _mm256_add_epi64(_mm256_sub_epi64(z, x), c);
+            t = mont64_csub_avx2(ntt_shoup_avx2(t, ws, wsp), q);
+            t = _mm256_add_epi64(t, _mm256_loadu_si256(
+                    (const __m256i *)(y + SPARROW_N / 2 + i)));
+            rec_group_avx2(k, ho, h, i + SPARROW_N / 2,
+                           mont64_csub_avx2(t, q), r);
+        }
+    }
+}
+
+PLAT_TARGET_AVX2
+static void polyr_intt_help_avx2(uint8_t *k, uint8_t *h, int64_t *v,
+                                 const int64_t *y, const uint64_t *r)
+{
+    intt_lazy_avx2(v);
+    intt_rec_final_avx2(k, h, h, v, y, r);
+}
+
+PLAT_TARGET_AVX2
+static void polyr_intt_rec_avx2(uint8_t *k, int64_t *v, const int64_t *y,
+                                const uint8_t *h)
+{
+    intt_lazy_avx2(v);
+    intt_rec_final_avx2(k, NULL, h, v, y, NULL);
+}
+
+//  === AVX-512 backend
+
+//  Same decomposition as mont64_mulq_avx2(), with native 64-bit products
+//  and arithmetic shifts.
+
+PLAT_TARGET_AVX512
+static inline __m512i mont64_mulq_avx512(__m512i x, __m512i y)
+{
+    const __m512i q = _mm512_set1_epi64(SPARROW_Q);
+    const __m512i qi = _mm512_set1_epi64(MONT_QI);
+    __m512i p, r;
+
+    p = _mm512_mul_epi32(x, y);
+    r = _mm512_mullo_epi64(p, qi);
+    p = _mm512_add_epi64(p, _mm512_mul_epu32(r, q));
+    p = _mm512_add_epi64(_mm512_srai_epi64(p, 32),
+                         _mm512_mul_epi32(_mm512_srli_epi64(r, 32), q));
+
+    return _mm512_srai_epi64(p, 32);
+}
+
+PLAT_TARGET_AVX512
+static inline __m512i mont64_cadd_avx512(__m512i x, __m512i m)
+{
+    return _mm512_add_epi64(x, _mm512_and_si512(_mm512_srai_epi64(x, 63), m));
+}
+
+PLAT_TARGET_AVX512
+static inline __m512i mont64_csub_avx512(__m512i x, __m512i m)
+{
+    return mont64_cadd_avx512(_mm512_sub_epi64(x, m), m);
+}
+
+PLAT_TARGET_AVX512
+static inline __m512i ntt_shoup_avx512(__m512i y, __m512i w, __m512i wp)
+{
+    const __m512i q = _mm512_set1_epi64(SPARROW_Q);
+    __m512i t;
+
+    t = _mm512_srli_epi64(_mm512_mul_epu32(y, wp), SPARROW_SHOUP_K);
+    return _mm512_sub_epi64(_mm512_mul_epu32(y, w), _mm512_mul_epu32(t, q));
+}
+
+//  one forward layer with "k" blocks of distance "j" >= 8
+
+PLAT_TARGET_AVX512
+static inline void fntt_layer_avx512(int64_t *v, size_t k, size_t j)
+{
+    size_t i, l;
+    __m512i x, y, z, zp;
+    int64_t *p0, *p1;
+    const int64_t (*w)[2] = &sparrow_wsh_64[k - 1];
+    const __m512i c = _mm512_set1_epi64(k == 1 ? SPARROW_Q : 0);
+    const __m512i q2 = _mm512_set1_epi64(2 * SPARROW_Q);
+
+    p0 = v;
+    for (i = 0; i < k; i++) {
+        z = _mm512_set1_epi64(w[i][0]);
+        zp = _mm512_set1_epi64(w[i][1]);
+        p1 = p0 + j;
+
+        for (l = 0; l < j; l += 8) {
+            x = _mm512_loadu_si512((const void *)(p0 + l));
+            y = _mm512_loadu_si512((const void *)(p1 + l));
+            x = _mm512_add_epi64(x, c);
+            y = ntt_shoup_avx512(_mm512_add_epi64(y, c), z, zp);
+            _mm512_storeu_si512((void *)(p0 + l), _mm512_add_epi64(x, y));
+            x = _mm512_add_epi64(x, q2);
+            _mm512_storeu_si512((void *)(p1 + l), _mm512_sub_epi64(x, y));
+        }
+        p0 = p1 + j;
+    }
+}
+
+//  one reverse layer with "k" blocks of distance "j" >= 8
+
+PLAT_TARGET_AVX512
+static inline void intt_layer_avx512(int64_t *v, size_t k, size_t j)
+{
+    size_t i, l;
+    __m512i x, y, z, zp;
+    int64_t *p0, *p1;
+    const int64_t (*w)[2] = &sparrow_wsh_64[2 * k - 2];
+    const __m512i c = _mm512_set1_epi64(j * SPARROW_Q);
+
+    p0 = v;
+    for (i = 0; i < k; i++) {
+        z = _mm512_set1_epi64(w[-i][0]);
+        zp = _mm512_set1_epi64(w[-i][1]);
+        p1 = p0 + j;
+
+        for (l = 0; l < j; l += 8) {
+            x = _mm512_loadu_si512((const void *)(p0 + l));
+            y = _mm512_loadu_si512((const void *)(p1 + l));
+            _mm512_storeu_si512((void *)(p0 + l), _mm512_add_epi64(x, y));
+            y = _mm512_add_epi64(_mm512_sub_epi64(y, x), c);
+            y = ntt_shoup_avx512(y, z, zp);
+            _mm512_storeu_si512((void *)(p1 + l), y);
+        }
+        p0 = p1 + j;
+    }
+}
+
+//  last reverse layer with the normalization, see intt_final()
+
+PLAT_TARGET_AVX512
+static inline void intt_final_avx512(int64_t *v)
+{
+    size_t i;
+    __m512i x, y;
+    int64_t *p1 = v + SPARROW_N / 2;
+    const __m512i q = _mm512_set1_epi64(SPARROW_Q);
+    const __m512i c = _mm512_set1_epi64((SPARROW_N / 2) * SPARROW_Q);
+    const __m512i s = _mm512_set1_epi64(sparrow_wsh_ni[0][0]);
+    const __m512i sp = _mm512_set1_epi64(sparrow_wsh_ni[0][1]);
+    const __m512i ws = _mm512_set1_epi64(sparrow_wsh_ni[1][0]);
+    const __m512i wsp = _mm512_set1_epi64(sparrow_wsh_ni[1][1]);
+
+    for (i = 0; i < SPARROW_N / 2; i += 8) {
+        x = _mm512_loadu_si512((const void *)(v + i));
+        y = _mm512_loadu_si512((const void *)(p1 + i));
+        _mm512_storeu_si512((void *)(v + i), mont64_csub_avx512(
+            ntt_shoup_avx512(_mm512_add_epi64(x, y), s, sp), q));
+        y = _mm512_add_epi64(_mm512_sub_epi64(y, x), c);
+        _mm512_storeu_si512((void *)(p1 + i), mont64_csub_avx512(
+            ntt_shoup_avx512(y, ws, wsp), q));
+    }
+}
+
+//  distance 4 layers use 256-bit vectors, the last two are scalar
+
+PLAT_TARGET_AVX512
+static void polyr_fntt_avx512(int64_t *v)
+{
+    size_t k, j;
+
+    for (k = 1, j = SPARROW_N >> 1; j >= 8; k <<= 1, j >>= 1) {
+        fntt_layer_avx512(v, k, j);
+    }
+    fntt_layer_avx2(v, k, j);
+    fntt_layers(v, k << 1, j >> 1);
+}
+
+PLAT_TARGET_AVX512
+static void polyr_ntt_smul_avx512(int64_t *r, const int64_t *a, int64_t c)
+{
+    size_t i;
+    __m512i x;
+    const __m512i q = _mm512_set1_epi64(SPARROW_Q);
+    const __m512i y = _mm512_set1_epi64(c);
+
+    for (i = 0; i < SPARROW_N; i += 8) {
+        x = _mm512_loadu_si512((const void *)(a + i));
+        x = mont64_cadd_avx512(mont64_mulq_avx512(x, y), q);
+        _mm512_storeu_si512((void *)(r + i), x);
+    }
+}
+
+//  all reverse layers but the last
+
+PLAT_TARGET_AVX512
+static inline void intt_lazy_avx512(int64_t *v)
+{
+    size_t k, j;
+
+    intt_layers(v, 1, 4);
+    intt_layer_avx2(v, SPARROW_N >> 3, 4);
+    for (j = 8, k = SPARROW_N >> 4; k > 1; j <<= 1, k >>= 1) {
+        intt_layer_avx512(v, k, j);
+    }
+}
+
+PLAT_TARGET_AVX512
+static void polyr_intt_avx512(int64_t *v)
+{
+    intt_lazy_avx512(v);
+    intt_final_avx512(v);
+}
+
+PLAT_TARGET_AVX512
+static void polyr_ntt_cmul_avx512(int64_t *r, const int64_t *a, const int64_t *b)
+{
+    size_t i;
+    __m512i x, y;
+    const __m512i q = _mm512_set1_epi64(SPARROW_Q);
+
+    for (i = 0; i < SPARROW_N; i += 8) {
+        x = _mm512_loadu_si512((const void *)(a + i));
+        y = _mm512_loadu_si512((const void *)(b + i));
+        x = mont64_cadd_avx512(mont64_mulq_avx512(x, y), q);
+        _mm512_storeu_si512((void *)(r + i), x);
+    }
+}
+
+PLAT_TARGET_AVX512
+static void polyr_ntt_mula_avx512(int64_t *r, const int64_t *a, const int64_t *b,
+                                  const int64_t *c)
+{
+    size_t i;
+    __m512i x, y;
+    const __m512i q = _mm512_set1_epi64(SPARROW_Q);
+
+    for (i = 0; i < SPARROW_N; i += 8) {
+        x = _mm512_loadu_si512((const void *)(a + i));
+        y = _mm512_loadu_si512((const void *)(b + i));
+        x = mont64_cadd_avx512(mont64_mulq_avx512(x, y), q);
+        y = _mm512_loadu_si512((const void *)(c + i));
+        x = mont64_csub_avx512(_mm512_add_epi64(x, y), q);
+        _mm512_storeu_si512((void *)(r + i), x);
+    }
+}
+
+//  Fused output stage, see rec_parity_avx2() and rec_key_avx2()
+
+PLAT_TARGET_AVX512
+static inline __mmask8 rec_parity_avx512(__m512i x)
+{
+    size_t j;
+    __mmask8 p = 0;
+
+    for (j = 1; j < REC_CUTOFFS - 1; j++) {
+        p ^= _mm512_cmpgt_epi64_mask(x, _mm512_set1_epi64(REC_CUTOFF(j) - 1));
+    }
+    return p;
+}
+
+PLAT_TARGET_AVX512
+static inline __m512i rec_key_avx512(__m512i w, __m512i b)
+{
+    size_t j;
+    __mmask8 m, p;
+    __m512i lo, hi, x;
+    const __m512i one = _mm512_set1_epi64(1);
+    const __m512i q2 = _mm512_set1_epi64(2 * SPARROW_Q);
+
+    p = 0;
+    lo = _mm512_setzero_si512();
+    hi = _mm512_set1_epi64(REC_CUTOFF(1));
+    for (j = 1; j < REC_CUTOFFS - 1; j++) {
+        m = _mm512_cmpgt_epi64_mask(w, _mm512_set1_epi64(REC_CUTOFF(j) - 1));
+        p ^= m;
+        lo = _mm512_mask_add_epi64(lo, m, lo,
+                _mm512_set1_epi64(REC_CUTOFF(j) - REC_CUTOFF(j - 1)));
+        hi = _mm512_mask_add_epi64(hi, m, hi,
+                _mm512_set1_epi64(REC_CUTOFF(j + 1) - REC_CUTOFF(j)));
+    }
+
+    m = _mm512_cmpgt_epi64_mask(_mm512_add_epi64(lo, hi),
+                                _mm512_add_epi64(w, w));
+    x = _mm512_mask_blend_epi64(m, hi, _mm512_sub_epi64(lo, one));
+    m = _mm512_cmpeq_epi64_mask(_mm512_maskz_mov_epi64(p, one), b);
+    x = _mm512_mask_blend_epi64(m, x, w);
+    x = mont64_csub_avx512(mont64_cadd_avx512(x, q2), q2);
+
+    x = _mm512_add_epi64(_mm512_slli_epi64(x, SPARROW_B - 1),
+                         _mm512_set1_epi64(SPARROW_Q / 2));
+    lo = _mm512_setzero_si512();
+    for (j = 1; j <= 4; j++) {
+        m = _mm512_cmpgt_epi64_mask(x, _mm512_set1_epi64(j * SPARROW_Q - 1));
+        lo = _mm512_mask_add_epi64(lo, m, lo, one);
+    }
+    return _mm512_and_si512(lo, _mm512_set1_epi64(3));
+}
+
+//  hints (with "r") and key bits of coefficients i .. i + 7
+
+PLAT_TARGET_AVX512
+static inline void rec_group_avx512(uint8_t *k, uint8_t *ho, const uint8_t *h,
+                                    size_t i, __m512i v, const uint64_t *r)
+{
+    uint64_t u;
+    __m512i w, x;
+    const __m512i one = _mm512_set1_epi64(1);
+
+    w = _mm512_add_epi64(v, v);
+    if (r != NULL) {
+        x = _mm512_srlv_epi64(_mm512_set1_epi64(r[i / 32] >> (2 * (i % 32))),
+                              _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14));
+        x = _mm512_sub_epi64(_mm512_and_si512(x, one),
+                             _mm512_and_si512(_mm512_srli_epi64(x, 1), one));
+        x = _mm512_maskz_mov_epi64(
+                rec_parity_avx512(_mm512_add_epi64(w, x)), one);
+        _mm_storel_epi64((__m128i *)(ho + i), _mm512_cvtepi64_epi8(x));
+    }
+    x = _mm512_cvtepu8_epi64(_mm_loadl_epi64((const __m128i *)(h + i)));
+    x = rec_key_avx512(w, x);
+    x = _mm512_sllv_epi64(x, _mm512_setr_epi64(6, 4, 2, 0, 6, 4, 2, 0));
+
+    //  eight lanes to two bytes
+    u = _mm_cvtsi128_si64(_mm512_cvtepi64_epi8(x));
+    u |= u >> 16;
+    u |= u >> 8;
+    k[i / 4] = u;
+    k[i / 4 + 1] = u >> 32;
+}
+
+PLAT_TARGET_AVX512
+static inline void intt_rec_final_avx512(uint8_t *k, uint8_t *ho,
+                                         const uint8_t *h, int64_t *v,
+                                         const int64_t *y, const uint64_t *r)
+{
+    size_t i;
+    __m512i x, z, t;
+    int64_t *p1 = v + SPARROW_N / 2;
+    const __m512i q = _mm512_set1_epi64(SPARROW_Q);
+    const __m512i c = _mm512_set1_epi64((SPARROW_N / 2) * SPARROW_Q);
+    const __m512i s = _mm512_set1_epi64(sparrow_wsh_ni[0][0]);
+    const __m512i sp = _mm512_set1_epi64(sparrow_wsh_ni[0][1]);
+    const __m512i ws = _mm512_set1_epi64(sparrow_wsh_ni[1][0]);
+    const __m512i wsp = _mm512_set1_epi64(sparrow_wsh_ni[1][1]);
+
+    for (i = 0; i < SPARROW_N / 2 && i < SPARROW_CTBITS; i += 8) {
+        x = _mm512_loadu_si512((const void *)(v + i));
+        z = _mm512_loadu_si512((const void *)(p1 + i));
+        t = mont64_csub_avx512(
+                ntt_shoup_avx512(_mm512_add_epi64(x, z), s, sp), q);
+        t = _mm512_add_epi64(t, _mm512_loadu_si512((const void *)(y + i)));
+        rec_group_avx512(k, ho, h, i, mont64_csub_avx512(t, q), r);
+        if (i + SPARROW_N / 2 < SPARROW_CTBITS) {
+            t = _mm512_add_epi64(_mm512_sub_epi64(z, x), c);
+            t = mont64_csub_avx512(ntt_shoup_avx512(t, ws, wsp), q);
+            t = _mm512_add_epi64(t, _mm512_loadu_si512(
+                    (const void *)(y + SPARROW_N / 2 + i)));
+            rec_group_avx512(k, ho, h, i + SPARROW_N / 2,
+                             mont64_csub_avx512(t, q), r);
+        }
+    }
+}
+
+PLAT_TARGET_AVX512
+static void polyr_intt_help_avx512(uint8_t *k, uint8_t *h, int64_t *v,
+                                   const int64_t *y, const uint64_t *r)
+{
+    intt_lazy_avx512(v);
+    intt_rec_final_avx512(k, h, h, v, y, r);
+}
+
+PLAT_TARGET_AVX512
+static void polyr_intt_rec_avx512(uint8_t *k, int64_t *v, const int64_t *y,
+                                  const uint8_t *h)
+{
+    intt_lazy_avx512(v);
+    intt_rec_final_avx512(k, NULL, h, v, y, NULL);
+}
+
+#else
+#define polyr_fntt_avx2         polyr_fntt_ref
+#define polyr_intt_avx2         polyr_intt_ref
+#define polyr_ntt_smul_avx2     polyr_ntt_smul_ref
+#define polyr_ntt_cmul_avx2     polyr_ntt_cmul_ref
+#define polyr_ntt_mula_avx2     polyr_ntt_mula_ref
+#define polyr_fntt_avx512       polyr_fntt_ref
+#define polyr_intt_avx512       polyr_intt_ref
+#define polyr_ntt_smul_avx512   polyr_ntt_smul_ref
+#define polyr_ntt_cmul_avx512   polyr_ntt_cmul_ref
+#define polyr_ntt_mula_avx512   polyr_ntt_mula_ref
+#define polyr_intt_help_avx2    polyr_intt_help_ref
+#define polyr_intt_rec_avx2     polyr_intt_rec_ref
+#define polyr_intt_help_avx512  polyr_intt_help_ref
+#define polyr_intt_rec_avx512   polyr_intt_rec_ref
+//  PLAT_CPU_X64
+#endif
+
+//  === Runtime dispatch
+
+static void (*const polyr_fntt_tab[PLAT_CPU_LEVELS])(int64_t *v) = {
+    polyr_fntt_ref, polyr_fntt_avx2, polyr_fntt_avx512
+};
+
+static void (*const polyr_intt_tab[PLAT_CPU_LEVELS])(int64_t *v) = {
+    polyr_intt_ref, polyr_intt_avx2, polyr_intt_avx512
+};
+
+static void (*const polyr_ntt_smul_tab[PLAT_CPU_LEVELS])
+            (int64_t *r, const int64_t *a, int64_t c) = {
+    polyr_ntt_smul_ref, polyr_ntt_smul_avx2, polyr_ntt_smul_avx512
+};
+
+static void (*const polyr_ntt_cmul_tab[PLAT_CPU_LEVELS])
+            (int64_t *r, const int64_t *a, const int64_t *b) = {
+    polyr_ntt_cmul_ref, polyr_ntt_cmul_avx2, polyr_ntt_cmul_avx512
+};
+
+static void (*const polyr_ntt_mula_tab[PLAT_CPU_LEVELS])
+            (int64_t *r, const int64_t *a, const int64_t *b,
+             const int64_t *c) = {
+    polyr_ntt_mula_ref, polyr_ntt_mula_avx2, polyr_ntt_mula_avx512
+};
+
+static void (*const polyr_intt_help_tab[PLAT_CPU_LEVELS])
+            (uint8_t *k, uint8_t *h, int64_t *v, const int64_t *y,
+             const uint64_t *r) = {
+    polyr_intt_help_ref, polyr_intt_help_avx2, polyr_intt_help_avx512
+};
+
+static void (*const polyr_intt_rec_tab[PLAT_CPU_LEVELS])
+            (uint8_t *k, int64_t *v, const int64_t *y, const uint8_t *h) = {
+    polyr_intt_rec_ref, polyr_intt_rec_avx2, polyr_intt_rec_avx512
+};
+
+//  Forward NTT (negacyclic -- evaluate polynomial at factors of x^n+1).
+
+void polyr_fntt(int64_t *v)
+{
+    polyr_fntt_tab[plat_cpu_level()](v);
+}
+
+//  Reverse NTT (negacyclic -- x^n+1), normalize by 1/(n*r).
+
+void polyr_intt(int64_t *v)
+{
+    polyr_intt_tab[plat_cpu_level()](v);
+}
+
+//  Scalar multiplication, Montgomery reduction.
+
+void polyr_ntt_smul(int64_t *r, const int64_t *a, int64_t c)
+{
+    polyr_ntt_smul_tab[plat_cpu_level()](r, a, c);
+}
+
+//  Coefficient multiply:  r = a * b,  Montgomery reduction.
+
+void polyr_ntt_cmul(int64_t *r, const int64_t *a, const int64_t *b)
+{
+    polyr_ntt_cmul_tab[plat_cpu_level()](r, a, b);
+}
+
+//  Coefficient multiply and add:  r = a * b + c, Montgomery reduction.
+
+void polyr_ntt_mula(int64_t *r, const int64_t *a, const int64_t *b,
+                    const int64_t *c)
+{
+    polyr_ntt_mula_tab[plat_cpu_level()](r, a, b, c);
+}
+
+//  Fused output stage of encaps: reverse NTT of v, v += y, hints h and
+//  key bits k of the first SPARROW_CTBITS coefficients.
+
+void polyr_intt_help(uint8_t *k, uint8_t *h, int64_t *v, const int64_t *y,
+                     const uint64_t *r)
+{
+    polyr_intt_help_tab[plat_cpu_level()](k, h, v, y, r);
+}
+
+//  Fused output stage of decaps: reverse NTT of v, v += y, key bits k
+//  from the hints h.
+
+void polyr_intt_rec(uint8_t *k, int64_t *v, const int64_t *y,
+                    const uint8_t *h)
+{
+    polyr_intt_rec_tab[plat_cpu_level()](k, v, y, h);
+}
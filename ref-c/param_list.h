@@ -1,3 +1,30 @@
+//  param_list.h
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Sparrow KEM parameter sets.
+
+//  All parameter sets. The Makefile compiles the parameter-dependent
+//  sources once for each X(set) line, and sparrow_kem.c lists them in the
+//  runtime table; adding a set here is all that is needed.
+
+#define SPARROW_PARAM_SETS(X) \
+    X(SPARROW_128_1_)
+
+//  Experimental sets without a security or failure rate analysis, for
+//  xbench and xtest only: built (B(set) lines) with "make BENCH_SETS=1",
+//  which defines SPARROW_BENCH_SETS. Never in the default library.
+
+#define SPARROW_BENCH_PARAM_SETS(B) \
+    B(SPARROW_128_1_C64_)
+
+//  The sets of this build.
+
+#ifdef SPARROW_BENCH_SETS
+#define SPARROW_BUILD_SETS(X) SPARROW_PARAM_SETS(X) SPARROW_BENCH_PARAM_SETS(X)
+#else
+#define SPARROW_BUILD_SETS(X) SPARROW_PARAM_SETS(X)
+#endif
+
 
 
 #if defined(SPARROW_128_1_)
@@ -12,7 +39,28 @@
 #define SPARROW_CTBITS 128
 #define SPARROW_K_SZ   32
 #define SPARROW_PK_SZ  2016
-#define SPARROW_SK_SZ  4032
+#define SPARROW_SK_SZ  4096
 #define SPARROW_CT1_SZ 16
-#define SPARROW_CT_SZ  32 + SPARROW_CT1_SZ
+#define SPARROW_CT_SZ  (32 + SPARROW_CT1_SZ)
+#endif
+
+//  (experimental) Sparrow-128-1 reconciling only the first 64 coefficients:
+//  2 * 64 key bits, a shorter ciphertext, and half of the last inverse NTT
+//  layer
+
+#if defined(SPARROW_128_1_C64_)
+#define SPARROW_(s)    SPARROW_128_1_C64__##s
+#define SPARROW_NAME   "Sparrow-128-1-c64"
+#define SPARROW_KAPPA  128
+#define SPARROW_Q      260609l
+#define SPARROW_N      128
+#define SPARROW_ELL    7
+#define SPARROW_K      7
+#define SPARROW_B      2
+#define SPARROW_CTBITS 64
+#define SPARROW_K_SZ   16
+#define SPARROW_PK_SZ  2016
+#define SPARROW_SK_SZ  4096
+#define SPARROW_CT1_SZ 8
+#define SPARROW_CT_SZ  (32 + SPARROW_CT1_SZ)
 #endif
@@ -1,2 +1,8 @@
-#define SPARROW_128_1_
+//  param_select.h
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Default parameter set, unless one is selected with -D<set>.
 
+#if !defined(SPARROW_128_1_) && !defined(SPARROW_128_1_C64_)
+#define SPARROW_128_1_
+#endif
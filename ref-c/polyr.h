@@ -13,6 +13,36 @@ extern "C" {
 #include <stdint.h>
 #include <stddef.h>
 
+#include "sparrow_param.h"
+
+//  === Global namespace prefix
+#ifdef SPARROW_
+#define polyr_zero       SPARROW_(polyr_zero)
+#define polyr_copy       SPARROW_(polyr_copy)
+#define polyr_add        SPARROW_(polyr_add)
+#define polyr_sub        SPARROW_(polyr_sub)
+#define polyr_addq       SPARROW_(polyr_addq)
+#define polyr_ntt_addq   SPARROW_(polyr_ntt_addq)
+#define polyr_subq       SPARROW_(polyr_subq)
+#define polyr_ntt_subq   SPARROW_(polyr_ntt_subq)
+#define polyr_addm       SPARROW_(polyr_addm)
+#define polyr_subm       SPARROW_(polyr_subm)
+#define polyr_negm       SPARROW_(polyr_negm)
+#define polyr_shlm       SPARROW_(polyr_shlm)
+#define polyr_shrm       SPARROW_(polyr_shrm)
+#define polyr_round      SPARROW_(polyr_round)
+#define polyr_center     SPARROW_(polyr_center)
+#define polyr_nonneg     SPARROW_(polyr_nonneg)
+#define polyr_ntt_smul   SPARROW_(polyr_ntt_smul)
+#define polyr_ntt_cmul   SPARROW_(polyr_ntt_cmul)
+#define polyr_ntt_mula   SPARROW_(polyr_ntt_mula)
+#define polyr_fntt       SPARROW_(polyr_fntt)
+#define polyr_intt       SPARROW_(polyr_intt)
+#define polyr_intt_help  SPARROW_(polyr_intt_help)
+#define polyr_intt_rec   SPARROW_(polyr_intt_rec)
+#define polyr_small_mula SPARROW_(polyr_small_mula)
+#endif
+
 //  Zeroize a polynomial:   r = 0.
 void polyr_zero(int64_t *r);
 
@@ -72,11 +102,35 @@ void polyr_ntt_mula(int64_t *r, const int64_t *a, const int64_t *b,
                     const int64_t *c);
 
 //  Forward NTT (negacyclic -- evaluate polynomial at factors of x^n+1).
+//  Input |v[i]| < q, output lazily reduced to 0 <= v[i] < (2 + 2 lg n) q.
 void polyr_fntt(int64_t *v);
 
 //  Reverse NTT (negacyclic -- x^n+1), normalize by 1/(n*r).
+//  Input 0 <= v[i] < q, output 0 <= v[i] < q.
 void polyr_intt(int64_t *v);
 
+//  Fused output stage of encaps: polyr_intt(v), v += y (|y[i]| < q/8),
+//  then help_recvec() with the random words r of help_rand() into the
+//  hints h, and rec_vec() into the key bits k -- for the first
+//  SPARROW_CTBITS coefficients, in one pass. v is overwritten.
+void polyr_intt_help(uint8_t *k, uint8_t *h, int64_t *v, const int64_t *y,
+                     const uint64_t *r);
+
+//  Fused output stage of decaps: as polyr_intt_help() with the hints h
+//  given.
+void polyr_intt_rec(uint8_t *k, int64_t *v, const int64_t *y,
+                    const uint8_t *h);
+
+//  Largest |s[i]| of polyr_small_mula() (small Gaussian secrets are well
+//  below this).
+#define POLYR_SMALL_MAX 63
+
+//  Small multiply and add:  r = a * s + c  (mod q, x^n + 1), without the
+//  NTT. Normal domain; 0 <= a[i], c[i] < q, |s[i]| <= POLYR_SMALL_MAX,
+//  output 0 <= r[i] < q.
+void polyr_small_mula(int64_t *r, const int64_t *a, const int64_t *s,
+                      const int64_t *c);
+
 #ifdef POLYR_Q32
 //  2x32 CRT: Split into two-prime representation (in-place).
 void polyr2_split(int64_t *v);
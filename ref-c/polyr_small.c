@@ -0,0 +1,278 @@
+//  polyr_small.c
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Multiplication by a polynomial with small coefficients (Gaussian
+//      secrets) without the NTT: negacyclic schoolbook in 32-bit lanes.
+
+#include <stddef.h>
+
+#include "polyr.h"
+#include "mont64.h"
+#include "plat_cpu.h"
+
+#ifdef PLAT_CPU_X64
+#include <immintrin.h>
+#endif
+
+//  The sums are exact in 32 bits: a is centered to |a| <= q/2, so each
+//  coefficient of a * s is below n * (q/2) * POLYR_SMALL_MAX < 2^31.
+
+#if (SPARROW_N * (SPARROW_Q / 2) * POLYR_SMALL_MAX >= (1ll << 31))
+#error "Small multiplication exceeds 32 bits for this (n, q)."
+#endif
+
+//  The vector products use pmaddwd: a centered coefficient x is split into
+//  the int16 pair (x mod 2^L, x >> L) and s into (s, s << L), so that one
+//  multiply-add of the pairs is x * s.
+
+#define SMALL_L     (SPARROW_Q_BITS / 2)
+
+#if ((SPARROW_Q / 2) >> SMALL_L) >= (1 << 15) || \
+    (POLYR_SMALL_MAX << SMALL_L) >= (1 << 15)
+#error "Small multiplication pairs exceed 16 bits for this q."
+#endif
+
+//  Reduction of |x| < 2^31: two folds with 2^QB = F (mod q) leave
+//  -q < x < 2q when (with H the largest second-fold high part) H * F < q
+//  and 2^QB + H * F < 2q.
+
+#define SMALL_F     ((1ll << SPARROW_Q_BITS) - SPARROW_Q)
+#define SMALL_H     (((SMALL_F << (31 - SPARROW_Q_BITS)) >> SPARROW_Q_BITS) + 1)
+
+#if (SMALL_H * SMALL_F >= SPARROW_Q) || \
+    ((1ll << SPARROW_Q_BITS) + SMALL_H * SMALL_F >= 2 * SPARROW_Q)
+#error "Small multiplication reduction bounds fail for this q."
+#endif
+
+static inline int64_t small_reduce(int64_t x)
+{
+    x = (x >> SPARROW_Q_BITS) * SMALL_F + (x & SPARROW_QMSK);
+    x = (x >> SPARROW_Q_BITS) * SMALL_F + (x & SPARROW_QMSK);
+    x += (x >> 63) & SPARROW_Q;
+    return mont64_csub(x, SPARROW_Q);
+}
+
+//  centered 0 <= x < q  ->  -q/2 <= x < q/2
+
+static inline int64_t small_center(int64_t x)
+{
+    return mont64_sub(mont64_csub(mont64_add(x, SPARROW_Q >> 1), SPARROW_Q),
+                      SPARROW_Q >> 1);
+}
+
+//  === Portable backend
+
+static void polyr_small_mula_ref(int64_t *r, const int64_t *a,
+                                 const int64_t *s, const int64_t *c)
+{
+    size_t i, j;
+    int32_t ext[2 * SPARROW_N], acc[SPARROW_N], sj;
+
+    //  r[i] = sum_j s[j] * ext[n + i - j], ext[n + m] = a[m], ext[m] = -a[m]
+    for (i = 0; i < SPARROW_N; i++) {
+        ext[SPARROW_N + i] = small_center(a[i]);
+        ext[i] = -ext[SPARROW_N + i];
+        acc[i] = 0;
+    }
+    for (j = 0; j < SPARROW_N; j++) {
+        sj = s[j];
+        for (i = 0; i < SPARROW_N; i++) {
+            acc[i] += sj * ext[SPARROW_N + i - j];
+        }
+    }
+    for (i = 0; i < SPARROW_N; i++) {
+        r[i] = mont64_csub(small_reduce(acc[i]) + c[i], SPARROW_Q);
+    }
+}
+
+#ifdef PLAT_CPU_X64
+
+//  The pairs of a centered, negacyclically extended as above.
+
+static inline int32_t small_pair(int64_t x)
+{
+    return (int32_t) ((uint32_t) (x & ((1 << SMALL_L) - 1)) |
+                      ((uint32_t) (x >> SMALL_L) << 16));
+}
+
+static inline void small_ext(int32_t *ext, const int64_t *a)
+{
+    size_t i;
+    int64_t x;
+
+    for (i = 0; i < SPARROW_N; i++) {
+        x = small_center(a[i]);
+        ext[SPARROW_N + i] = small_pair(x);
+        ext[i] = small_pair(-x);
+    }
+}
+
+static inline int32_t small_pair_s(int64_t s)
+{
+    return (int32_t) ((uint32_t) (uint16_t) s |
+                      ((uint32_t) (uint16_t) (s << SMALL_L) << 16));
+}
+
+//  === AVX2 backend
+
+//  64 coefficients (eight accumulators) per pass
+
+#define SMALL_AVX2_BLK  8
+
+PLAT_TARGET_AVX2
+static inline __m256i small_reduce_avx2(__m256i x)
+{
+    const __m256i f = _mm256_set1_epi32(SMALL_F);
+    const __m256i msk = _mm256_set1_epi32(SPARROW_QMSK);
+    const __m256i q = _mm256_set1_epi32(SPARROW_Q);
+
+    x = _mm256_add_epi32(_mm256_mullo_epi32(
+            _mm256_srai_epi32(x, SPARROW_Q_BITS), f), _mm256_and_si256(x, msk));
+    x = _mm256_add_epi32(_mm256_mullo_epi32(
+            _mm256_srai_epi32(x, SPARROW_Q_BITS), f), _mm256_and_si256(x, msk));
+    x = _mm256_add_epi32(x, _mm256_and_si256(_mm256_srai_epi32(x, 31), q));
+    x = _mm256_sub_epi32(x, q);
+    return _mm256_add_epi32(x, _mm256_and_si256(_mm256_srai_epi32(x, 31), q));
+}
+
+//  r = x + c (mod q) for four reduced 32-bit lanes x
+
+PLAT_TARGET_AVX2
+static inline void small_addq_avx2(int64_t *r, __m128i x, const int64_t *c)
+{
+    const __m256i q = _mm256_set1_epi64x(SPARROW_Q);
+    __m256i y;
+
+    y = _mm256_add_epi64(_mm256_cvtepi32_epi64(x),
+                         _mm256_loadu_si256((const __m256i *) c));
+    y = _mm256_sub_epi64(y, q);
+    y = _mm256_add_epi64(y, _mm256_and_si256(
+            _mm256_cmpgt_epi64(_mm256_setzero_si256(), y), q));
+    _mm256_storeu_si256((__m256i *) r, y);
+}
+
+PLAT_TARGET_AVX2
+static void polyr_small_mula_avx2(int64_t *r, const int64_t *a,
+                                  const int64_t *s, const int64_t *c)
+{
+    size_t i, j, k;
+    int32_t ext[2 * SPARROW_N];
+    __m256i acc[SMALL_AVX2_BLK], sj, x;
+
+    small_ext(ext, a);
+    for (i = 0; i < SPARROW_N; i += 8 * SMALL_AVX2_BLK) {
+        for (k = 0; k < SMALL_AVX2_BLK; k++) {
+            acc[k] = _mm256_setzero_si256();
+        }
+        for (j = 0; j < SPARROW_N; j++) {
+            sj = _mm256_set1_epi32(small_pair_s(s[j]));
+            for (k = 0; k < SMALL_AVX2_BLK; k++) {
+                x = _mm256_loadu_si256((const __m256i *)
+                                       (ext + SPARROW_N + i + 8 * k - j));
+                acc[k] = _mm256_add_epi32(acc[k], _mm256_madd_epi16(x, sj));
+            }
+        }
+        for (k = 0; k < SMALL_AVX2_BLK; k++) {
+            x = small_reduce_avx2(acc[k]);
+            small_addq_avx2(r + i + 8 * k, _mm256_castsi256_si128(x),
+                            c + i + 8 * k);
+            small_addq_avx2(r + i + 8 * k + 4, _mm256_extracti128_si256(x, 1),
+                            c + i + 8 * k + 4);
+        }
+    }
+}
+
+//  === AVX-512 backend
+
+//  128 coefficients (eight accumulators) per pass
+
+#define SMALL_AVX512_BLK    8
+
+PLAT_TARGET_AVX512
+static inline __m512i small_reduce_avx512(__m512i x)
+{
+    const __m512i f = _mm512_set1_epi32(SMALL_F);
+    const __m512i msk = _mm512_set1_epi32(SPARROW_QMSK);
+    const __m512i q = _mm512_set1_epi32(SPARROW_Q);
+
+    x = _mm512_add_epi32(_mm512_mullo_epi32(
+            _mm512_srai_epi32(x, SPARROW_Q_BITS), f), _mm512_and_si512(x, msk));
+    x = _mm512_add_epi32(_mm512_mullo_epi32(
+            _mm512_srai_epi32(x, SPARROW_Q_BITS), f), _mm512_and_si512(x, msk));
+    x = _mm512_mask_add_epi32(x, _mm512_movepi32_mask(x), x, q);
+    x = _mm512_sub_epi32(x, q);
+    return _mm512_mask_add_epi32(x, _mm512_movepi32_mask(x), x, q);
+}
+
+//  r = x + c (mod q) for eight reduced 32-bit lanes x
+
+PLAT_TARGET_AVX512
+static inline void small_addq_avx512(int64_t *r, __m256i x, const int64_t *c)
+{
+    const __m512i q = _mm512_set1_epi64(SPARROW_Q);
+    __m512i y;
+
+    y = _mm512_add_epi64(_mm512_cvtepi32_epi64(x),
+                         _mm512_loadu_si512((const void *) c));
+    y = _mm512_sub_epi64(y, q);
+    y = _mm512_mask_add_epi64(y, _mm512_movepi64_mask(y), y, q);
+    _mm512_storeu_si512((void *) r, y);
+}
+
+PLAT_TARGET_AVX512
+static void polyr_small_mula_avx512(int64_t *r, const int64_t *a,
+                                    const int64_t *s, const int64_t *c)
+{
+    size_t i, j, k;
+    int32_t ext[2 * SPARROW_N];
+    __m512i acc[SMALL_AVX512_BLK], sj, x;
+
+    small_ext(ext, a);
+    for (i = 0; i < SPARROW_N; i += 16 * SMALL_AVX512_BLK) {
+        for (k = 0; k < SMALL_AVX512_BLK; k++) {
+            acc[k] = _mm512_setzero_si512();
+        }
+        for (j = 0; j < SPARROW_N; j++) {
+            sj = _mm512_set1_epi32(small_pair_s(s[j]));
+            for (k = 0; k < SMALL_AVX512_BLK; k++) {
+                x = _mm512_loadu_si512((const void *)
+                                       (ext + SPARROW_N + i + 16 * k - j));
+                acc[k] = _mm512_add_epi32(acc[k], _mm512_madd_epi16(x, sj));
+            }
+        }
+        for (k = 0; k < SMALL_AVX512_BLK; k++) {
+            x = small_reduce_avx512(acc[k]);
+            small_addq_avx512(r + i + 16 * k, _mm512_castsi512_si256(x),
+                              c + i + 16 * k);
+            small_addq_avx512(r + i + 16 * k + 8,
+                              _mm512_extracti64x4_epi64(x, 1),
+                              c + i + 16 * k + 8);
+        }
+    }
+}
+
+#if (SPARROW_N % (16 * SMALL_AVX512_BLK)) != 0
+#error "SPARROW_N is not a multiple of the small multiplication blocks."
+#endif
+
+#else
+#define polyr_small_mula_avx2   polyr_small_mula_ref
+#define polyr_small_mula_avx512 polyr_small_mula_ref
+//  PLAT_CPU_X64
+#endif
+
+//  === Runtime dispatch
+
+static void (*const polyr_small_mula_tab[PLAT_CPU_LEVELS])
+            (int64_t *r, const int64_t *a, const int64_t *s,
+             const int64_t *c) = {
+    polyr_small_mula_ref, polyr_small_mula_avx2, polyr_small_mula_avx512
+};
+
+//  Small multiply and add:  r = a * s + c  (mod q, x^n + 1).
+
+void polyr_small_mula(int64_t *r, const int64_t *a, const int64_t *s,
+                      const int64_t *c)
+{
+    polyr_small_mula_tab[plat_cpu_level()](r, a, s, c);
+}
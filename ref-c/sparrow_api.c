@@ -5,65 +5,264 @@
 
 #include <string.h>
 #include <stdio.h>
+#include <limits.h>
 
 #include "api.h"
 #include "sparrow_core.h"
 #include "sparrow_serial.h"
 #include "xof_sample.h"
+#include "sparrow_kem.h"
+#include "ct_util.h"
+#include "plat_prof.h"
+
+//  === Global namespace prefix
+#ifdef SPARROW_
+#define sparrow_kem_desc SPARROW_(kem)
+#endif
+
+//  the workspace layout must fit the advertised size
+typedef char racc_ws_sz_chk[sizeof(racc_ws_t) <= CRYPTO_WORKSPACEBYTES ? 1 : -1];
+typedef char racc_batch_ws_sz_chk[sizeof(racc_batch_ws_t) <=
+                                  CRYPTO_BATCH_WORKSPACEBYTES ? 1 : -1];
+typedef char racc_pkp_sz_chk[sizeof(racc_pk_t) <= CRYPTO_PREPAREDPKBYTES ? 1 : -1];
+
+//  Check the alignment of a caller-provided workspace.
+
+static inline racc_ws_t *racc_ws(void *ws)
+{
+    return ((uintptr_t) ws & 7) == 0 ? (racc_ws_t *) ws : NULL;
+}
+
+//  Wipe the secret parts of the workspace (the public key and ciphertext
+//  are not secret) and return "ret".
+
+static int racc_ws_done(racc_ws_t *w, int ret)
+{
+    ct_memzero(&w->sk, sizeof(w->sk));
+    ct_memzero(&w->tmp, sizeof(w->tmp));
+    return ret;
+}
 
 //  Generates a keypair - pk is the public key and sk is the secret key.
 
 int
-crypto_sign_keypair(  unsigned char *pk, unsigned char *sk, int transpose)
+crypto_sign_keypair_ws(unsigned char *pk, unsigned char *sk, int transpose,
+                       void *ws)
 {
-    racc_pk_t   r_pk;           //  internal-format public key
-    racc_sk_t   r_sk;           //  internal-format secret key
+    size_t l, l_sk;
+    racc_ws_t *w = racc_ws(ws);
 
-    sparrow_core_keygen(&r_pk, &r_sk, transpose); //  generate keypair
+    if (w == NULL)
+        return -1;
+
+    //  generate keypair
+    sparrow_core_keygen(&w->pk, &w->sk, transpose, &w->tmp);
 
     //  serialize
-    if (CRYPTO_PUBLICKEYBYTES != racc_encode_pk(pk, &r_pk) ||
-        CRYPTO_SECRETKEYBYTES != racc_encode_sk(sk, &r_sk))
-        return -1;
+    PROF(PROF_ENCODE, l = racc_encode_pk(pk, &w->pk));
+    PROF(PROF_ENCODE, l_sk = racc_encode_sk(sk, &w->sk));
+    if (CRYPTO_PUBLICKEYBYTES != l || CRYPTO_SECRETKEYBYTES != l_sk)
+        return racc_ws_done(w, -1);
 
-    return  0;
+    return racc_ws_done(w, 0);
 }
 
+//  Encapsulate to the decoded public key "pkA".
 
-int crypto_encaps(unsigned char *K, unsigned char *ct, const unsigned char *pkA, const unsigned char *skB)
+static int racc_encaps_w(unsigned char *K, unsigned char *ct, const racc_pk_t *pkA, const unsigned char *skB,
+                         racc_ws_t *w)
+{
+    size_t l;
+
+    //  deserialize secret key
+    PROF(PROF_DECODE, l = racc_decode_sk(&w->sk, skB));
+    if (CRYPTO_SECRETKEYBYTES != l)
+        return racc_ws_done(w, -1);
+
+    sparrow_core_encaps(K, &w->ct, pkA, &w->sk, &w->tmp);
+    PROF(PROF_ENCODE, racc_encode_ct(ct, &w->ct));
+
+    return racc_ws_done(w, 0);
+}
+
+//  Decapsulate with the decoded public key "pkB".
+
+static int racc_decaps_w(unsigned char *K, const unsigned char *ct, const racc_pk_t *pkB, const unsigned char *skA,
+                         racc_ws_t *w)
 {
-    racc_sk_t r_skB;   //  internal-format secret key
-    racc_pk_t r_pkA;   //  internal-format secret key
-    racc_ciphertext_t r_ct;   //  internal-format ciphertext
+    size_t l;
+
+    //  deserialize secret key
+    PROF(PROF_DECODE, l = racc_decode_sk(&w->sk, skA));
+    if (CRYPTO_SECRETKEYBYTES != l)
+        return racc_ws_done(w, -1);
+
+    PROF(PROF_DECODE, racc_decode_ct(&w->ct, ct));
+    sparrow_core_decaps(K, &w->ct, pkB, &w->sk, NULL, &w->tmp);
+
+    return racc_ws_done(w, 0);
+}
+
+int crypto_encaps_ws(unsigned char *K, unsigned char *ct, const unsigned char *pkA, const unsigned char *skB,
+                     void *ws)
+{
+    size_t l;
+    racc_ws_t *w = racc_ws(ws);
+
+    if (w == NULL)
+        return -1;
 
     //  deserialize public key
-    if (CRYPTO_PUBLICKEYBYTES != racc_decode_pk(&r_pkA, pkA)) 
+    PROF(PROF_DECODE, l = racc_decode_pk(&w->pk, pkA));
+    if (CRYPTO_PUBLICKEYBYTES != l)
         return -1;
-    //  deserialize secret key
-    if (CRYPTO_SECRETKEYBYTES != racc_decode_sk(&r_skB, skB))
+
+    return racc_encaps_w(K, ct, &w->pk, skB, w);
+}
+
+int crypto_decaps_ws(unsigned char *K, const unsigned char *ct, const unsigned char *pkB, const unsigned char *skA,
+                     void *ws)
+{
+    size_t l;
+    racc_ws_t *w = racc_ws(ws);
+
+    if (w == NULL)
+        return -1;
+
+    //  deserialize public key
+    PROF(PROF_DECODE, l = racc_decode_pk(&w->pk, pkB));
+    if (CRYPTO_PUBLICKEYBYTES != l)
+        return -1;
+
+    return racc_decaps_w(K, ct, &w->pk, skA, w);
+}
+
+int crypto_decaps_batch_ws(unsigned char *K, const unsigned char *ct, const unsigned char *pkB, const unsigned char *skA,
+                           size_t n, void *ws)
+{
+    size_t i, l;
+    int ret;
+    racc_batch_ws_t *bw = (racc_batch_ws_t *) ws;
+    racc_ws_t *w = racc_ws(ws);             //  &bw->ws, or NULL
+
+    if (w == NULL || n > INT_MAX)
         return -1;
 
-    sparrow_core_encaps(K, &r_ct, &r_pkA, &r_skB);
-    racc_encode_ct(ct, &r_ct);
+    //  deserialize secret key once
+    PROF(PROF_DECODE, l = racc_decode_sk(&w->sk, skA));
+    if (CRYPTO_SECRETKEYBYTES != l)
+        return racc_ws_done(w, -1);
+
+    //  one seeded noise stream for the whole batch
+    gauss_stream_init(&bw->gs);
+    ret = 0;
+    for (i = 0; i < n; i++) {
+        PROF(PROF_DECODE, l = racc_decode_pk(&w->pk,
+                                pkB + i * CRYPTO_PUBLICKEYBYTES));
+        if (CRYPTO_PUBLICKEYBYTES != l) {
+            //  no partial output: keys already derived are wiped too
+            ct_memzero(K, n * CRYPTO_SHAREDKEY);
+            ret = -1;
+            break;
+        }
+        PROF(PROF_DECODE, racc_decode_ct(&w->ct, ct + i * CRYPTO_BYTES));
+        sparrow_core_decaps(K + i * CRYPTO_SHAREDKEY, &w->ct, &w->pk,
+                            &w->sk, &bw->gs, &w->tmp);
+    }
+    gauss_stream_clear(&bw->gs);
+
+    return racc_ws_done(w, ret);
+}
+
+//  The same with the workspace on the stack.
+
+int
+crypto_sign_keypair(  unsigned char *pk, unsigned char *sk, int transpose)
+{
+    racc_ws_t ws;
+
+    return crypto_sign_keypair_ws(pk, sk, transpose, &ws);
+}
+
+int crypto_encaps(unsigned char *K, unsigned char *ct, const unsigned char *pkA, const unsigned char *skB)
+{
+    racc_ws_t ws;
 
-    return 0;
+    return crypto_encaps_ws(K, ct, pkA, skB, &ws);
 }
 
 int crypto_decaps(unsigned char *K, const unsigned char *ct, const unsigned char *pkB, const unsigned char *skA)
 {
-    racc_sk_t r_skA; //  internal-format secret key
-    racc_pk_t r_pkB; //  internal-format secret key
-    racc_ciphertext_t r_ct; //  internal-format ciphertext
+    racc_ws_t ws;
 
-    //  deserialize public key
-    if (CRYPTO_PUBLICKEYBYTES != racc_decode_pk(&r_pkB, pkB))
+    return crypto_decaps_ws(K, ct, pkB, skA, &ws);
+}
+
+int crypto_decaps_batch(unsigned char *K, const unsigned char *ct, const unsigned char *pkB, const unsigned char *skA,
+                        size_t n)
+{
+    racc_batch_ws_t ws;
+
+    return crypto_decaps_batch_ws(K, ct, pkB, skA, n, &ws);
+}
+
+//  Prepared public keys: decoded once, then used in place.
+
+int crypto_prepare_pk(void *pkp, const unsigned char *pk)
+{
+    size_t l;
+
+    if (((uintptr_t) pkp & 7) != 0)
         return -1;
-    //  deserialize secret key
-    if (CRYPTO_SECRETKEYBYTES != racc_decode_sk(&r_skA, skA))
+    PROF(PROF_DECODE, l = racc_decode_pk((racc_pk_t *) pkp, pk));
+
+    return CRYPTO_PUBLICKEYBYTES == l ? 0 : -1;
+}
+
+int crypto_encaps_pkp_ws(unsigned char *K, unsigned char *ct, const void *pkpA, const unsigned char *skB,
+                         void *ws)
+{
+    racc_ws_t *w = racc_ws(ws);
+
+    if (w == NULL || ((uintptr_t) pkpA & 7) != 0)
+        return -1;
+    return racc_encaps_w(K, ct, (const racc_pk_t *) pkpA, skB, w);
+}
+
+int crypto_decaps_pkp_ws(unsigned char *K, const unsigned char *ct, const void *pkpB, const unsigned char *skA,
+                         void *ws)
+{
+    racc_ws_t *w = racc_ws(ws);
+
+    if (w == NULL || ((uintptr_t) pkpB & 7) != 0)
         return -1;
+    return racc_decaps_w(K, ct, (const racc_pk_t *) pkpB, skA, w);
+}
+
+int crypto_encaps_pkp(unsigned char *K, unsigned char *ct, const void *pkpA, const unsigned char *skB)
+{
+    racc_ws_t ws;
+
+    return crypto_encaps_pkp_ws(K, ct, pkpA, skB, &ws);
+}
+
+int crypto_decaps_pkp(unsigned char *K, const unsigned char *ct, const void *pkpB, const unsigned char *skA)
+{
+    racc_ws_t ws;
 
-    racc_decode_ct(&r_ct, ct);
-    return sparrow_core_decaps(K, &r_ct, &r_pkB, &r_skA);
+    return crypto_decaps_pkp_ws(K, ct, pkpB, skA, &ws);
 }
 
+//  Entry for the runtime parameter set table in sparrow_kem.c.
 
+const sparrow_kem_t sparrow_kem_desc = {
+    CRYPTO_ALGNAME,
+    CRYPTO_PUBLICKEYBYTES, CRYPTO_SECRETKEYBYTES,
+    CRYPTO_BYTES, CRYPTO_SHAREDKEY, SPARROW_CRH,
+    crypto_sign_keypair, crypto_encaps, crypto_decaps,
+    CRYPTO_WORKSPACEBYTES, CRYPTO_STACKBYTES,
+    crypto_sign_keypair_ws, crypto_encaps_ws, crypto_decaps_ws,
+    CRYPTO_BATCH_WORKSPACEBYTES, crypto_decaps_batch, crypto_decaps_batch_ws,
+    CRYPTO_PREPAREDPKBYTES, crypto_prepare_pk, crypto_encaps_pkp,
+    crypto_decaps_pkp, crypto_encaps_pkp_ws, crypto_decaps_pkp_ws
+};
@@ -17,10 +17,11 @@
 #include "gauss_sample.h"
 #include "sparrow_rec.h"
 #include "sha3_t.h"
+#include "plat_prof.h"
 
 //  ExpandA(): Use domain separated XOF to create matrix elements
 
-static void expand_aij( int64_t aij[SPARROW_N], int i_k, int i_ell)
+static void sample_aij( int64_t aij[SPARROW_N], int i_k, int i_ell)
 {
     uint8_t buf[SPARROW_AS_SZ + 8];
 
@@ -31,24 +32,32 @@ static void expand_aij( int64_t aij[SPARROW_N], int i_k, int i_ell)
     memset(buf + 3, 0x00, 8 - 3);
 
     //  --- 4.  Ai,j <- SampleQ(hdrA, seed)
-    xof_sample_q(aij, buf, 8);
+    PROF(PROF_XOF, xof_sample_q(aij, buf, 8));
+}
+
+#ifndef SPARROW_SMALL_MUL
 
-    //  converted to NTT domain
-    polyr_fntt(aij);
+//  ExpandA() element converted to NTT domain
+
+static void expand_aij( int64_t aij[SPARROW_N], int i_k, int i_ell)
+{
+    sample_aij(aij, i_k, i_ell);
+    PROF(PROF_NTT, polyr_fntt(aij));
 }
 
 //  === sparrow_core_keygen ===
 //  Generate a public-secret keypair ("pk", "sk").
 
-void sparrow_core_keygen(racc_pk_t *pk, racc_sk_t *sk, int transpose)
+void sparrow_core_keygen(racc_pk_t *pk, racc_sk_t *sk, int transpose,
+                         racc_tmp_t *tmp)
 {
     int i, j;
-    int64_t aij[SPARROW_N];
-    int64_t ttmp[SPARROW_N];
+    int64_t *aij = tmp->v;
+    int64_t *ttmp = tmp->ttmp;
 
     for (i = 0; i < SPARROW_ELL; i++) {
-        small_sample_gauss_vector(sk->s[i], SPARROW_N);
-        polyr_fntt(sk->s[i]);
+        PROF(PROF_GAUSS, small_sample_gauss_vector(sk->s[i], SPARROW_N));
+        PROF(PROF_NTT, polyr_fntt(sk->s[i]));
     }
 
     for (i = 0; i < SPARROW_K; i++) {
@@ -57,105 +66,184 @@ void sparrow_core_keygen(racc_pk_t *pk, racc_sk_t *sk, int transpose)
         //  --- 2.  A := ExpandA(seed)
         for (j = 0; j < SPARROW_ELL; j++) {
             expand_aij(aij, transpose ? j : i,  transpose ? i : j);
-            polyr_ntt_mula(ttmp, sk->s[j], aij, ttmp);
+            PROF(PROF_MULA, polyr_ntt_mula(ttmp, sk->s[j], aij, ttmp));
         }
-        polyr_intt(ttmp);
+        PROF(PROF_INTT, polyr_intt(ttmp));
 
         //  ---  Sample e
-        small_sample_gauss_vector(pk->t[i], SPARROW_N);
+        PROF(PROF_GAUSS, small_sample_gauss_vector(pk->t[i], SPARROW_N));
         //  ---  t <- (A*s) + e
         polyr_addq(pk->t[i], pk->t[i], ttmp);
     }
 
+    //  implicit rejection secret, independent of s
+    randombytes(sk->z, SPARROW_Z_SZ);
+
     //  --- 9.  return ( (vk := seed, t), sk:= (vk, [[s]]) )
     memcpy(&sk->pk, pk, sizeof(racc_pk_t));
 }
 
+#else
 
-//  === sparrow_core_encaps ===
+//  === sparrow_core_keygen ===
+//  The same with t = A * s by polyr_small_mula() in the normal domain
+//  (-DSPARROW_SMALL_MUL): no NTT of A and no inverse NTT. The random
+//  draws and the key pair are those of the NTT version.
 
-void sparrow_core_encaps(uint8_t *K, racc_ciphertext_t *ct, const racc_pk_t *pkA, const racc_sk_t *skB)
+void sparrow_core_keygen(racc_pk_t *pk, racc_sk_t *sk, int transpose,
+                         racc_tmp_t *tmp)
 {
-    int i;
-    size_t l;
-    int64_t y[SPARROW_CTBITS];
-    int64_t ttmp[SPARROW_N], v[SPARROW_N];
-    uint8_t Ktmp[SPARROW_K_SZ];
-    uint8_t buf[1 + 2 * SPARROW_TR_SZ + SPARROW_CT1_SZ + SPARROW_K_SZ];
+    int i, j;
+    int64_t *aij = tmp->v;
+    int64_t *ttmp = tmp->ttmp;
 
-    polyr_zero(v);
-    for (i = 0; i < SPARROW_K; i++)
-    {
-        polyr_copy(ttmp, pkA->t[i]);
-        polyr_fntt(ttmp);
-        polyr_ntt_mula(v, skB->s[i], ttmp, v);
+    for (i = 0; i < SPARROW_K; i++) {
+        polyr_zero(pk->t[i]);
     }
 
-    polyr_intt(v);
+    //  column j of A * s, then s_j moves to the NTT domain
+    for (j = 0; j < SPARROW_ELL; j++) {
+        PROF(PROF_GAUSS, small_sample_gauss_vector(sk->s[j], SPARROW_N));
 
-    // Sample encapsulation noise
-    large_sample_gauss_vector(y, SPARROW_CTBITS);
-    polyr_addq(v, v, y);
+        //  --- 2.  A := ExpandA(seed)
+        for (i = 0; i < SPARROW_K; i++) {
+            sample_aij(aij, transpose ? j : i,  transpose ? i : j);
+            PROF(PROF_MULA, polyr_small_mula(pk->t[i], aij, sk->s[j],
+                                             pk->t[i]));
+        }
+        PROF(PROF_NTT, polyr_fntt(sk->s[j]));
+    }
 
-    help_recvec(v, ct);
-    rec_vec(Ktmp, v, ct);
+    for (i = 0; i < SPARROW_K; i++) {
+        //  ---  Sample e
+        PROF(PROF_GAUSS, small_sample_gauss_vector(ttmp, SPARROW_N));
+        //  ---  t <- (A*s) + e
+        polyr_addq(pk->t[i], pk->t[i], ttmp);
+    }
 
-    // Compute final shared key and hash check t
-    l = 1;
-    memcpy(buf+l, pkA->tr, SPARROW_TR_SZ); l += SPARROW_TR_SZ;
-    memcpy(buf+l, skB->pk.tr, SPARROW_TR_SZ); l += SPARROW_TR_SZ;
+    //  implicit rejection secret, independent of s
+    randombytes(sk->z, SPARROW_Z_SZ);
+
+    //  --- 9.  return ( (vk := seed, t), sk:= (vk, [[s]]) )
+    memcpy(&sk->pk, pk, sizeof(racc_pk_t));
+}
+
+//  SPARROW_SMALL_MUL
+#endif
+
+//  Derive the shared key "K" and the hash check "t" from one SHAKE256
+//  output:  K || t = SHAKE256('K' || tr_a || tr_b || ct1 || Ktmp).
+//  (K is the same as with a separate 32-byte squeeze.)
+
+static void derive_kt(uint8_t *K, uint8_t *t, const uint8_t *tr_a,
+                      const uint8_t *tr_b, const racc_ciphertext_t *ct,
+                      const uint8_t *Ktmp)
+{
+    size_t l;
+    uint8_t buf[1 + 2 * SPARROW_TR_SZ + SPARROW_CT1_SZ + SPARROW_K_SZ];
+    uint8_t kt[SPARROW_K_SZ + SPARROW_CRH];
+
+    l = 0;
+    buf[l++] = 'K';
+    memcpy(buf+l, tr_a, SPARROW_TR_SZ); l += SPARROW_TR_SZ;
+    memcpy(buf+l, tr_b, SPARROW_TR_SZ); l += SPARROW_TR_SZ;
     racc_encode_ct1(buf+l, ct); l += SPARROW_CT1_SZ;
     memcpy(buf+l, Ktmp, SPARROW_K_SZ);
 
-    buf[0] = 'K';
-    shake256(K, SPARROW_K_SZ, buf, sizeof(buf));
-    buf[0] = 't';
-    shake256(ct->t, SPARROW_K_SZ, buf, sizeof(buf));
+    PROF(PROF_HASH, shake256(kt, sizeof(kt), buf, sizeof(buf)));
+    memcpy(K, kt, SPARROW_K_SZ);
+    memcpy(t, kt + SPARROW_K_SZ, SPARROW_CRH);
+
+    ct_memzero(buf, sizeof(buf));
+    ct_memzero(kt, sizeof(kt));
+}
+
+//  Implicit rejection key:  K = SHAKE256('J' || z || ct1 || t).
+
+static void derive_rej(uint8_t *K, const uint8_t *z,
+                       const racc_ciphertext_t *ct)
+{
+    size_t l;
+    uint8_t buf[1 + SPARROW_Z_SZ + SPARROW_CT1_SZ + SPARROW_CRH];
+
+    l = 0;
+    buf[l++] = 'J';
+    memcpy(buf+l, z, SPARROW_Z_SZ); l += SPARROW_Z_SZ;
+    racc_encode_ct1(buf+l, ct); l += SPARROW_CT1_SZ;
+    memcpy(buf+l, ct->t, SPARROW_CRH);
+
+    PROF(PROF_HASH, shake256(K, SPARROW_K_SZ, buf, sizeof(buf)));
+    ct_memzero(buf, sizeof(buf));
 }
 
 //  === sparrow_core_encaps ===
 
-int sparrow_core_decaps(uint8_t *K, const racc_ciphertext_t *ct, const racc_pk_t *pkB, const racc_sk_t *skA)
+void sparrow_core_encaps(uint8_t *K, racc_ciphertext_t *ct, const racc_pk_t *pkA, const racc_sk_t *skB,
+                         racc_tmp_t *tmp)
 {
     int i;
-    size_t l;
-    int64_t y[SPARROW_CTBITS];
-    int64_t ttmp[SPARROW_N], v[SPARROW_N];
+    int64_t *y = tmp->y;
+    int64_t *ttmp = tmp->ttmp, *v = tmp->v;
     uint8_t Ktmp[SPARROW_K_SZ];
-    uint8_t buf[1 + 2 * SPARROW_TR_SZ + SPARROW_CT1_SZ + SPARROW_K_SZ];
-    uint8_t t[SPARROW_CRH];
+    uint64_t r[REC_RAND_WORDS];
 
     polyr_zero(v);
     for (i = 0; i < SPARROW_K; i++)
     {
-        polyr_copy(ttmp, pkB->t[i]);
-        polyr_fntt(ttmp);
-        polyr_ntt_mula(v, skA->s[i], ttmp, v);
+        polyr_copy(ttmp, pkA->t[i]);
+        PROF(PROF_NTT, polyr_fntt(ttmp));
+        PROF(PROF_MULA, polyr_ntt_mula(v, skB->s[i], ttmp, v));
     }
 
-    polyr_intt(v);
-
-    // Sample encapsulation noise
-    small_sample_gauss_vector(y, SPARROW_CTBITS);
-    polyr_addq(v, v, y);
+    // Sample encapsulation noise and the hint randomness
+    PROF(PROF_GAUSS, large_sample_gauss_vector(y, SPARROW_CTBITS));
+    PROF(PROF_REC, help_rand(r));
 
-    rec_vec(Ktmp, v, ct);
+    // Fused intt, v += y, help_recvec and rec_vec
+    PROF(PROF_INTT, polyr_intt_help(Ktmp, ct->ct, v, y, r));
+    ct_memzero(r, sizeof(r));
 
     // Compute final shared key and hash check t
-    l = 1;
-    memcpy(buf+l, skA->pk.tr, SPARROW_TR_SZ); l += SPARROW_TR_SZ;
-    memcpy(buf+l, pkB->tr, SPARROW_TR_SZ); l += SPARROW_TR_SZ;
-    racc_encode_ct1(buf+l, ct); l += SPARROW_CT1_SZ;
-    memcpy(buf+l, Ktmp, SPARROW_K_SZ);
+    derive_kt(K, ct->t, pkA->tr, skB->pk.tr, ct, Ktmp);
+    ct_memzero(Ktmp, sizeof(Ktmp));
+}
+
+//  === sparrow_core_decaps ===
 
-    buf[0] = 't';
-    shake256(t, SPARROW_K_SZ, buf, sizeof(buf));
-    if (memcmp(t, ct->t, SPARROW_CRH) != 0) {
-        return 1;
+void sparrow_core_decaps(uint8_t *K, const racc_ciphertext_t *ct, const racc_pk_t *pkB, const racc_sk_t *skA,
+                         gauss_stream_t *gs, racc_tmp_t *tmp)
+{
+    int i;
+    bool ok;
+    int64_t *y = tmp->y;
+    int64_t *ttmp = tmp->ttmp, *v = tmp->v;
+    uint8_t Ktmp[SPARROW_K_SZ], Kt[SPARROW_K_SZ];
+    uint8_t t[SPARROW_CRH];
+
+    polyr_zero(v);
+    for (i = 0; i < SPARROW_K; i++)
+    {
+        polyr_copy(ttmp, pkB->t[i]);
+        PROF(PROF_NTT, polyr_fntt(ttmp));
+        PROF(PROF_MULA, polyr_ntt_mula(v, skA->s[i], ttmp, v));
     }
 
-    buf[0] = 'K';
-    shake256(K, SPARROW_K_SZ, buf, sizeof(buf));
+    // Sample decapsulation noise
+    if (gs != NULL)
+        PROF(PROF_GAUSS, gauss_stream_small(gs, y, SPARROW_CTBITS));
+    else
+        PROF(PROF_GAUSS, small_sample_gauss_vector(y, SPARROW_CTBITS));
 
-    return 0;
+    // Fused intt, v += y and rec_vec
+    PROF(PROF_INTT, polyr_intt_rec(Ktmp, v, y, ct->ct));
+
+    // Compute final shared key and hash check t
+    derive_kt(Kt, t, skA->pk.tr, pkB->tr, ct, Ktmp);
+    ct_memzero(Ktmp, sizeof(Ktmp));
+
+    //  select Kt or the rejection key without branching on the check
+    derive_rej(K, skA->z, ct);
+    ok = ct_equal(t, ct->t, SPARROW_CRH);
+    ct_cmov(K, Kt, SPARROW_K_SZ, ok);
+    ct_memzero(Kt, sizeof(Kt));
 }
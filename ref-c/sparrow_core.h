@@ -15,6 +15,7 @@ extern "C" {
 #include <stdbool.h>
 
 #include "sparrow_param.h"
+#include "gauss_sample.h"
 
 //  === Global namespace prefix
 #ifdef SPARROW_
@@ -36,6 +37,7 @@ typedef struct {
 typedef struct {
     racc_pk_t pk;                           //  copy of public key
     int64_t s[SPARROW_ELL][SPARROW_N];    //  d-masked secret key
+    uint8_t z[SPARROW_Z_SZ];                //  implicit rejection secret
 } racc_sk_t;
 
 //  raccoon signature
@@ -51,14 +53,44 @@ typedef struct {
     uint8_t t[SPARROW_CRH];
 } racc_ciphertext_t;
 
-//  === Core API ===
+//  scratch polynomials of the core functions
+typedef struct {
+    int64_t v[SPARROW_N];
+    int64_t ttmp[SPARROW_N];
+    int64_t y[SPARROW_CTBITS];
+} racc_tmp_t;
 
-//  Generate a public-secret keypair ("pk", "sk").
-void sparrow_core_keygen(racc_pk_t *pk, racc_sk_t *sk, int transpose);
+//  working memory of the api.h *_ws functions (CRYPTO_WORKSPACEBYTES)
+typedef struct {
+    racc_pk_t pk;
+    racc_sk_t sk;
+    racc_ciphertext_t ct;
+    racc_tmp_t tmp;
+} racc_ws_t;
 
-void sparrow_core_encaps(uint8_t *K, racc_ciphertext_t *ct, const racc_pk_t *pkA, const racc_sk_t *skB);
+//  working memory of crypto_decaps_batch_ws() (CRYPTO_BATCH_WORKSPACEBYTES)
+typedef struct {
+    racc_ws_t ws;
+    gauss_stream_t gs;
+} racc_batch_ws_t;
 
-int sparrow_core_decaps(uint8_t *K, const racc_ciphertext_t *ct, const racc_pk_t *pkB, const racc_sk_t *skA);
+//  === Core API ===
+
+//  The core functions keep their polynomial temporaries in "tmp".
+
+//  Generate a public-secret keypair ("pk", "sk").
+void sparrow_core_keygen(racc_pk_t *pk, racc_sk_t *sk, int transpose,
+                         racc_tmp_t *tmp);
+
+void sparrow_core_encaps(uint8_t *K, racc_ciphertext_t *ct, const racc_pk_t *pkA, const racc_sk_t *skB,
+                         racc_tmp_t *tmp);
+
+//  Constant time in the validity of "ct". If its hash check t does not
+//  match, K is the implicit rejection key SHAKE256('J' || z || ct); the
+//  validity is not returned. The noise comes from stream "gs", or from a
+//  freshly seeded sampler if "gs" is NULL.
+void sparrow_core_decaps(uint8_t *K, const racc_ciphertext_t *ct, const racc_pk_t *pkB, const racc_sk_t *skA,
+                         gauss_stream_t *gs, racc_tmp_t *tmp);
 
 #ifdef __cplusplus
 }
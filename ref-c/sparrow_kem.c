@@ -0,0 +1,120 @@
+//  sparrow_kem.c
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Runtime table of all compiled parameter sets, and locked memory
+//      for their workspaces.
+
+#include <string.h>
+#include <stdlib.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "sparrow_kem.h"
+#include "param_list.h"
+#include "ct_util.h"
+
+//  each set's sparrow_api.c defines SPARROW_(kem)
+
+#define SPARROW_KEM_DECL(set) extern const sparrow_kem_t set##_kem;
+SPARROW_BUILD_SETS(SPARROW_KEM_DECL)
+
+#define SPARROW_KEM_PTR(set) &set##_kem,
+static const sparrow_kem_t *const sparrow_kem_tab[] = {
+    SPARROW_BUILD_SETS(SPARROW_KEM_PTR)
+};
+
+#define SPARROW_KEM_NUM (sizeof(sparrow_kem_tab) / sizeof(sparrow_kem_tab[0]))
+
+//  Number of parameter sets in this build.
+
+size_t sparrow_kem_count(void)
+{
+    return SPARROW_KEM_NUM;
+}
+
+//  Parameter set "i", NULL if out of range.
+
+const sparrow_kem_t *sparrow_kem_get(size_t i)
+{
+    return i < SPARROW_KEM_NUM ? sparrow_kem_tab[i] : NULL;
+}
+
+//  Find a parameter set by name, NULL if not found.
+
+const sparrow_kem_t *sparrow_kem_by_name(const char *name)
+{
+    size_t i;
+
+    for (i = 0; i < SPARROW_KEM_NUM; i++) {
+        if (strcmp(sparrow_kem_tab[i]->name, name) == 0)
+            return sparrow_kem_tab[i];
+    }
+    return NULL;
+}
+
+//  === Locked memory
+
+#if defined(__unix__) || defined(__APPLE__)
+
+//  "sz" rounded up to whole pages
+
+static size_t sparrow_sec_len(size_t sz)
+{
+    size_t pg = (size_t) sysconf(_SC_PAGESIZE);
+
+    return (sz + pg - 1) / pg * pg;
+}
+
+//  Allocate "sz" zeroed, locked bytes. NULL on failure.
+
+void *sparrow_sec_alloc(size_t sz)
+{
+    void *p;
+    size_t len = sparrow_sec_len(sz);
+
+    p = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+             -1, 0);
+    if (p == MAP_FAILED)
+        return NULL;
+
+    //  best effort: fails beyond RLIMIT_MEMLOCK
+    (void) mlock(p, len);
+#ifdef MADV_DONTDUMP
+    (void) madvise(p, len, MADV_DONTDUMP);
+#endif
+    return p;
+}
+
+//  Wipe and release memory from sparrow_sec_alloc(sz).
+
+void sparrow_sec_free(void *p, size_t sz)
+{
+    size_t len = sparrow_sec_len(sz);
+
+    if (p == NULL)
+        return;
+    ct_memzero(p, len);
+    (void) munlock(p, len);
+    munmap(p, len);
+}
+
+#else
+
+void *sparrow_sec_alloc(size_t sz)
+{
+    return calloc(1, sz);
+}
+
+void sparrow_sec_free(void *p, size_t sz)
+{
+    if (p == NULL)
+        return;
+    ct_memzero(p, sz);
+    free(p);
+}
+
+//  __unix__
+#endif
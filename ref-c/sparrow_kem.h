@@ -0,0 +1,92 @@
+//  sparrow_kem.h
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Runtime table of all compiled parameter sets, and locked memory
+//      for their workspaces.
+
+#ifndef _SPARROW_KEM_H_
+#define _SPARROW_KEM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//  === Exported symbols (the library is built with -fvisibility=hidden)
+#ifndef SPARROW_API
+#if defined(__GNUC__) || defined(__clang__)
+#define SPARROW_API __attribute__((visibility("default")))
+#else
+#define SPARROW_API
+#endif
+#endif
+
+//  One parameter set: sizes in bytes and its (namespaced) api.h functions.
+
+typedef struct {
+    const char *name;               //  CRYPTO_ALGNAME
+    size_t pk_sz;                   //  CRYPTO_PUBLICKEYBYTES
+    size_t sk_sz;                   //  CRYPTO_SECRETKEYBYTES
+    size_t ct_sz;                   //  CRYPTO_BYTES
+    size_t k_sz;                    //  CRYPTO_SHAREDKEY
+    size_t t_sz;                    //  SPARROW_CRH: hash check t, at the
+                                    //  end of the ciphertext
+    int (*keypair)(unsigned char *pk, unsigned char *sk, int transpose);
+    int (*encaps)(unsigned char *K, unsigned char *ct,
+                  const unsigned char *pkA, const unsigned char *skB);
+    int (*decaps)(unsigned char *K, const unsigned char *ct,
+                  const unsigned char *pkB, const unsigned char *skA);
+    size_t ws_sz;                   //  CRYPTO_WORKSPACEBYTES
+    size_t stack_sz;                //  CRYPTO_STACKBYTES
+    int (*keypair_ws)(unsigned char *pk, unsigned char *sk, int transpose,
+                      void *ws);
+    int (*encaps_ws)(unsigned char *K, unsigned char *ct,
+                     const unsigned char *pkA, const unsigned char *skB,
+                     void *ws);
+    int (*decaps_ws)(unsigned char *K, const unsigned char *ct,
+                     const unsigned char *pkB, const unsigned char *skA,
+                     void *ws);
+    size_t batch_ws_sz;             //  CRYPTO_BATCH_WORKSPACEBYTES
+    int (*decaps_batch)(unsigned char *K, const unsigned char *ct,
+                        const unsigned char *pkB, const unsigned char *skA,
+                        size_t n);
+    int (*decaps_batch_ws)(unsigned char *K, const unsigned char *ct,
+                           const unsigned char *pkB,
+                           const unsigned char *skA, size_t n, void *ws);
+    size_t pkp_sz;                  //  CRYPTO_PREPAREDPKBYTES
+    int (*prepare_pk)(void *pkp, const unsigned char *pk);
+    int (*encaps_pkp)(unsigned char *K, unsigned char *ct, const void *pkpA,
+                      const unsigned char *skB);
+    int (*decaps_pkp)(unsigned char *K, const unsigned char *ct,
+                      const void *pkpB, const unsigned char *skA);
+    int (*encaps_pkp_ws)(unsigned char *K, unsigned char *ct,
+                         const void *pkpA, const unsigned char *skB, void *ws);
+    int (*decaps_pkp_ws)(unsigned char *K, const unsigned char *ct,
+                         const void *pkpB, const unsigned char *skA, void *ws);
+} sparrow_kem_t;
+
+//  Number of parameter sets in this build.
+SPARROW_API size_t sparrow_kem_count(void);
+
+//  Parameter set "i" (0 <= i < sparrow_kem_count()), NULL if out of range.
+SPARROW_API const sparrow_kem_t *sparrow_kem_get(size_t i);
+
+//  Find a parameter set by name (e.g. "Sparrow-128-1"), NULL if not found.
+SPARROW_API const sparrow_kem_t *sparrow_kem_by_name(const char *name);
+
+//  Allocate "sz" zeroed bytes (page aligned) for secret data such as a
+//  *_ws() workspace: locked in RAM where the memory limit allows it, and
+//  excluded from core dumps. NULL on failure.
+SPARROW_API void *sparrow_sec_alloc(size_t sz);
+
+//  Wipe and release memory from sparrow_sec_alloc(sz).
+SPARROW_API void sparrow_sec_free(void *p, size_t sz);
+
+#ifdef __cplusplus
+}
+#endif
+
+//  _SPARROW_KEM_H_
+#endif
@@ -26,6 +26,9 @@
 //  Size of public key hash used in BUFFing -- needs CRH
 #define SPARROW_TR_SZ  SPARROW_CRH
 
+//  Size of the implicit rejection secret z in the secret key
+#define SPARROW_Z_SZ   SPARROW_CRH
+
 //  size of pk-bound message mu = H(H(pk), msg)
 #define SPARROW_MU_SZ  SPARROW_CRH
 
@@ -36,15 +39,94 @@
 #define SPARROW_MK_SZ  SPARROW_SEC
 
 //  shared / derived parameters
-#if (SPARROW_Q == 260609) && (SPARROW_N == 128)
-#define SPARROW_Q_BITS 18
+#ifndef SPARROW_Q
+#error  "No known parameter defined."
+#endif
+
+#if   (SPARROW_N == 64)
+#define SPARROW_LGN    6
+#elif (SPARROW_N == 128)
 #define SPARROW_LGN    7
+#elif (SPARROW_N == 256)
+#define SPARROW_LGN    8
+#elif (SPARROW_N == 512)
+#define SPARROW_LGN    9
 #else
-#error  "No known parameter defined."
+#error  "Unsupported SPARROW_N."
+#endif
+
+#if   (SPARROW_Q < (1l << 12))
+#define SPARROW_Q_BITS 12
+#elif (SPARROW_Q < (1l << 13))
+#define SPARROW_Q_BITS 13
+#elif (SPARROW_Q < (1l << 14))
+#define SPARROW_Q_BITS 14
+#elif (SPARROW_Q < (1l << 15))
+#define SPARROW_Q_BITS 15
+#elif (SPARROW_Q < (1l << 16))
+#define SPARROW_Q_BITS 16
+#elif (SPARROW_Q < (1l << 17))
+#define SPARROW_Q_BITS 17
+#elif (SPARROW_Q < (1l << 18))
+#define SPARROW_Q_BITS 18
+#elif (SPARROW_Q < (1l << 19))
+#define SPARROW_Q_BITS 19
+#elif (SPARROW_Q < (1l << 20))
+#define SPARROW_Q_BITS 20
+#elif (SPARROW_Q < (1l << 21))
+#define SPARROW_Q_BITS 21
+#elif (SPARROW_Q < (1l << 22))
+#define SPARROW_Q_BITS 22
+#elif (SPARROW_Q < (1l << 23))
+#define SPARROW_Q_BITS 23
+#elif (SPARROW_Q < (1l << 24))
+#define SPARROW_Q_BITS 24
+#elif (SPARROW_Q < (1l << 25))
+#define SPARROW_Q_BITS 25
+#elif (SPARROW_Q < (1l << 26))
+#define SPARROW_Q_BITS 26
+#elif (SPARROW_Q < (1l << 27))
+#define SPARROW_Q_BITS 27
+#elif (SPARROW_Q < (1l << 28))
+#define SPARROW_Q_BITS 28
+#elif (SPARROW_Q < (1l << 29))
+#define SPARROW_Q_BITS 29
+#elif (SPARROW_Q < (1l << 30))
+#define SPARROW_Q_BITS 30
+#elif (SPARROW_Q < (1l << 31))
+#define SPARROW_Q_BITS 31
+#else
+#error  "Unsupported SPARROW_Q."
 #endif
 
 #define SPARROW_QMSK   ((1LL << SPARROW_Q_BITS) - 1)
 
+//  Working memory of the api.h *_ws functions (bytes, upper bound of
+//  sizeof(racc_ws_t): public key, secret key, ciphertext, 2 + 1 scratch
+//  polynomials, and padding).
+#define SPARROW_WS_SZ  (8 * ((2 * SPARROW_K + SPARROW_ELL + 2) * SPARROW_N + \
+                        SPARROW_CTBITS) + 2 * SPARROW_CTBITS + 256)
+
+//  Batch noise stream (gauss_stream_t): SHAKE256 rate in words, number
+//  of parallel Keccak states
+#define GAUSS_STREAM_RATE   17
+#define GAUSS_STREAM_WAYS   4
+
+//  Working memory of crypto_decaps_batch_ws() (bytes, upper bound of
+//  sizeof(racc_batch_ws_t)): the above and the stream's states, squeezed
+//  words, index, and padding.
+#define SPARROW_BATCH_WS_SZ (SPARROW_WS_SZ + 8 * (GAUSS_STREAM_WAYS * \
+                             (25 + GAUSS_STREAM_RATE) + 1) + 8)
+
+//  A public key prepared by crypto_prepare_pk() (bytes, upper bound of
+//  sizeof(racc_pk_t): the decoded t, the seed of A, and tr).
+#define SPARROW_PKP_SZ (8 * SPARROW_K * SPARROW_N + SPARROW_AS_SZ + \
+                        SPARROW_TR_SZ + 16)
+
+//  Maximum stack used by the *_ws functions (bytes, any backend); checked
+//  by xtest. The other api.h functions also need SPARROW_WS_SZ of stack.
+#define SPARROW_WS_STACK   8192
+
 //  "low bits" in Z encoding
 #define SPARROW_ZLBITS 40
 
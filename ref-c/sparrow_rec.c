@@ -6,24 +6,26 @@
 #include "nist_random.h"
 #include "sparrow_param.h"
 #include "sparrow_core.h"
+#include "sparrow_rec.h"
 #include "mont64.h"
 #include "sha3_t.h"
+#include "ct_util.h"
 
-#if (SPARROW_B != 2 || SPARROW_Q != 260609l)
-#error "Unrecognized polynomial parameters N, Q"
+//  rec_vec() packs two key bits per coefficient
+#if (SPARROW_B != 2)
+#error "Unsupported reconciliation parameter B"
 #endif
 
-static uint32_t CUTOFFS[] = {0, 65153, 130305, 195457, 260609, 325762, 390914, 456066, 521218};
-
 int help_rec(int v) {
     return (((1 << SPARROW_B) * v) / SPARROW_Q) & 1;
 }
 
-void help_recvec(int64_t *v, racc_ciphertext_t *ct)
+//  Random words of the hints: coefficient i uses bits 2 * (i % 32) and
+//  2 * (i % 32) + 1 of r[i / 32].
+
+void help_rand(uint64_t *r)
 {
     uint8_t seed[SPARROW_SEC + 8];
-    uint64_t rand; 
-    int l = 0;
 
     //  --- 4.  sigma <- {0,1}^kappa
     randombytes(seed + 8, SPARROW_SEC);
@@ -37,19 +39,24 @@ void help_recvec(int64_t *v, racc_ciphertext_t *ct)
     sha3_init(&kec, SHAKE256_RATE);
     sha3_absorb(&kec, seed, sizeof(seed));
     sha3_pad(&kec, SHAKE_PAD);
+    sha3_squeeze_words(&kec, r, REC_RAND_WORDS);
+
+    ct_memzero(seed, sizeof(seed));
+    sha3_clear(&kec);
+}
 
+void help_recvec(int64_t *v, racc_ciphertext_t *ct)
+{
+    uint64_t rand[REC_RAND_WORDS];
+
+    help_rand(rand);
     for (size_t i = 0; i < SPARROW_CTBITS; i++) {
-        if (l < 2) {
-            uint8_t buf[8];
-            sha3_squeeze(&kec, buf, sizeof(buf));
-            rand = get64u_le(buf);
-            l = 64;
-        }
-        int r1 = rand & 1; rand >>= 1;
-        int r2 = rand & 1; rand >>= 1;
-        l -= 2;
+        int r1 = (rand[i / 32] >> (2 * (i % 32))) & 1;
+        int r2 = (rand[i / 32] >> (2 * (i % 32) + 1)) & 1;
         ct->ct[i] = help_rec(2*v[i] + (r1-r2));
     }
+
+    ct_memzero(rand, sizeof(rand));
 }
 
 int closest_v(int w, int b) {
@@ -58,8 +65,8 @@ int closest_v(int w, int b) {
     int current_dist = SPARROW_Q;
     int current_closest_v = 0;
 
-    for (size_t i = 0; i < sizeof(CUTOFFS)/sizeof(CUTOFFS[0]); i++) {
-        int c = CUTOFFS[i];
+    for (size_t i = 0; i < REC_CUTOFFS; i++) {
+        int c = REC_CUTOFF(i);
 
         // Compute dist = abs(c-v) and s = c >= w
         int r = c - w;
@@ -1,16 +1,43 @@
+//  sparrow_rec.h
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Sparrow KEM scheme -- Reconciliation.
+
+#ifndef _SPARROW_REC_H_
+#define _SPARROW_REC_H_
+
 #include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 
 #include "sparrow_param.h"
+#include "sparrow_core.h"
 
-#ifndef _SPARROW_REC_H_
-#define _SPARROW_REC_H_
+//  === Global namespace prefix
+#ifdef SPARROW_
+#define help_rec        SPARROW_(help_rec)
+#define help_rand       SPARROW_(help_rand)
+#define help_recvec     SPARROW_(help_recvec)
+#define closest_v       SPARROW_(closest_v)
+#define rec_element     SPARROW_(rec_element)
+#define rec_vec         SPARROW_(rec_vec)
+#endif
+
+//  help_rec() changes value at v = ceil(i * q / 2^B), i = 0, 1, .. 2^(B+1)
+//  (scripts/gen_cutoffs.py lists them for the default parameters).
+
+#define REC_CUTOFFS    ((2 << SPARROW_B) + 1)
+#define REC_CUTOFF(i)  ((int)(((i) * SPARROW_Q + (1 << SPARROW_B) - 1) >> SPARROW_B))
+
+//  random words of the hints, two bits per coefficient
+#define REC_RAND_WORDS ((SPARROW_CTBITS + 31) / 32)
 
 int help_rec(int v);
+void help_rand(uint64_t *r);
 void help_recvec(int64_t *v, racc_ciphertext_t *ct);
 int closest_v(int w, int b);
 int rec_element(int w, int b);
 void rec_vec(uint8_t *K, const int64_t *v, const racc_ciphertext_t *ct);
 
-#endif
\ No newline at end of file
+//  _SPARROW_REC_H_
+#endif
@@ -13,6 +13,7 @@
 #include "nist_random.h"
 #include "mont64.h"
 #include "sha3_t.h"
+#include "ct_util.h"
 
 //  Encode vector v[SPARROW_N] as packed "bits" sized elements to  *b".
 //  Return the number of bytes written -- at most ceil(SPARROW_N * bits/8).
@@ -88,6 +89,23 @@ static inline size_t inline_decode_bits(int64_t *v, size_t v_sz, const uint8_t *
     return i;  //   return number of bytes read
 }
 
+//  Decode the t vector of a public key from "b". Return length in bytes.
+
+static size_t racc_decode_pk_t(racc_pk_t *pk, const uint8_t *b)
+{
+    size_t i, l;
+
+    l = 0;
+
+    //  decode t vector
+    for (i = 0; i < SPARROW_K; i++) {
+        //  domain is q; has log2(q) bits, unsigned
+        l += inline_decode_bits(pk->t[i], SPARROW_N, b + l, SPARROW_Q_BITS, false);
+    }
+
+    return l;
+}
+
 //  === Interface
 
 //  Encode the public key "pk" to bytes "b". Return length in bytes.
@@ -111,15 +129,9 @@ size_t racc_encode_pk(uint8_t *b, const racc_pk_t *pk)
 
 size_t racc_decode_pk(racc_pk_t *pk, const uint8_t *b)
 {
-    size_t i, l;
+    size_t l;
 
-    l = 0;
-
-    //  decode t vector
-    for (i = 0; i < SPARROW_K; i++) {
-        //  domain is q; has log2(q) bits, unsigned
-        l += inline_decode_bits(pk->t[i], SPARROW_N, b + l, SPARROW_Q_BITS, false);
-    }
+    l = racc_decode_pk_t(pk, b);
 
     //  also set the tr field
     shake256(pk->tr, SPARROW_TR_SZ, b, l);
@@ -128,25 +140,31 @@ size_t racc_decode_pk(racc_pk_t *pk, const uint8_t *b)
 }
 
 //  Encode secret key "sk" to bytes "b". Return length in bytes.
+//  Format: public key || s (SPARROW_ELL polynomials) || tr || z.
 
 size_t racc_encode_sk(uint8_t *b, const racc_sk_t *sk)
 {
-    size_t i, l;
-    int64_t s0[SPARROW_ELL][SPARROW_N];
+    size_t i, l, pk_l;
+    int64_t s0[SPARROW_N];
 
     //  encode public key
     l = racc_encode_pk(b, &sk->pk);
+    pk_l = l;
 
-    //  make a copy of share 0
+    //  encode the zeroth share (in full), one polynomial at a time
     for (i = 0; i < SPARROW_ELL; i++) {
-        polyr_copy(s0[i], sk->s[i]);
+        polyr_ntt_smul(s0, sk->s[i], MONT_R);
+        l += inline_encode_bits(b + l, s0, SPARROW_N, SPARROW_Q_BITS);
     }
+    ct_memzero(s0, sizeof(s0));
 
-    //  encode the zeroth share (in full)
-    for (i = 0; i < SPARROW_ELL; i++) {
-        polyr_ntt_smul(s0[i], s0[i], MONT_R);
-        l += inline_encode_bits(b + l, s0[i], SPARROW_N, SPARROW_Q_BITS);
-    }
+    //  hash of the public key, so that decoding does not recompute it
+    shake256(b + l, SPARROW_TR_SZ, b, pk_l);
+    l += SPARROW_TR_SZ;
+
+    //  rejection secret
+    memcpy(b + l, sk->z, SPARROW_Z_SZ);
+    l += SPARROW_Z_SZ;
 
     return l;
 }
@@ -157,18 +175,23 @@ size_t racc_decode_sk(racc_sk_t *sk, const uint8_t *b)
 {
     size_t i, l;
 
-    //  decode public key
-    l = racc_decode_pk(&sk->pk, b);
+    //  decode public key; tr is stored at the end
+    l = racc_decode_pk_t(&sk->pk, b);
 
     //  decode the zeroth share (in full)
     for (i = 0; i < SPARROW_ELL; i++) {
         l += inline_decode_bits(sk->s[i], SPARROW_N, b + l, SPARROW_Q_BITS, false);
     }
 
+    memcpy(sk->pk.tr, b + l, SPARROW_TR_SZ);
+    l += SPARROW_TR_SZ;
+    memcpy(sk->z, b + l, SPARROW_Z_SZ);
+    l += SPARROW_Z_SZ;
+
     return l;
 }
 
-//  Encode the ciphertext "ct" to bytes "b". Return length in bytes.
+//  Encode the reconciliation bits of "ct" to bytes "b". Return length.
 
 size_t racc_encode_ct1(uint8_t *b, const racc_ciphertext_t *ct)
 {
@@ -180,7 +203,6 @@ size_t racc_encode_ct1(uint8_t *b, const racc_ciphertext_t *ct)
 
     // l holds the length
     l = inline_encode_bits(b, tmp, SPARROW_CTBITS, 1);
-    memcpy(b + l, ct->t, SPARROW_CRH); l += SPARROW_CRH;
 
     return l;
 }
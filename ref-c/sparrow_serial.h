@@ -11,6 +11,7 @@
 #include <stdbool.h>
 
 #include "sparrow_param.h"
+#include "sparrow_core.h"
 
 //  === Global namespace prefix
 
@@ -21,6 +22,9 @@
 #define racc_decode_sk SPARROW_(decode_sk)
 #define racc_encode_sig SPARROW_(encode_sig)
 #define racc_decode_sig SPARROW_(decode_sig)
+#define racc_encode_ct  SPARROW_(encode_ct)
+#define racc_encode_ct1 SPARROW_(encode_ct1)
+#define racc_decode_ct  SPARROW_(decode_ct)
 #endif
 
 #ifdef __cplusplus
@@ -43,8 +47,10 @@ size_t racc_decode_sk(racc_sk_t *sk, const uint8_t *b);
 //  bytes or zero in case of overflow.
 size_t racc_encode_ct(uint8_t *b, const racc_ciphertext_t *ct);
 
-//  decode bytes "b" into ciphertext "ct". Return length in bytes.
+//  Encode only the reconciliation bits of "ct" (SPARROW_CT1_SZ bytes).
 size_t racc_encode_ct1(uint8_t *b, const racc_ciphertext_t *ct);
+
+//  decode bytes "b" into ciphertext "ct". Return length in bytes.
 size_t racc_decode_ct(racc_ciphertext_t *ct, const uint8_t *b);
 
 #ifdef __cplusplus
@@ -9,6 +9,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
 
 #include "plat_local.h"
 #include "sparrow_core.h"
@@ -19,6 +20,11 @@
 #include "sha3_t.h"
 #include "gauss_sample.h"
 #include "sparrow_rec.h"
+#include "plat_cpu.h"
+#include "sparrow_kem.h"
+#include "sys_random.h"
+#include "ct_util.h"
+#include "plat_prof.h"
 
 #include "api.h"
 
@@ -59,14 +65,225 @@ static inline double cpu_clock_secs()
 //  maximum message size
 #define MAX_MSG 256
 
+//  Time "calls" requests of "bytes" total on source "fill(ctx, ..)",
+//  direct (sz = 0) or through a buffer of "sz" bytes.
+
+static void bench_rng(const char *label, uint64_t calls, uint64_t bytes,
+                      const char *src, rng_fill_t fill, void *ctx,
+                      size_t sz, double to)
+{
+    size_t i, j, iter;
+    double ts;
+    uint64_t cc;
+    uint8_t buf[MAX_MSG];
+    rng_buf_t rb;
+    size_t len = calls > 0 ? bytes / calls : 0;
+
+    if (len > sizeof(buf))
+        len = sizeof(buf);
+
+    rng_buf_init(&rb, fill, ctx, sz);
+
+    iter = 16;
+    do {
+        iter *= 2;
+        ts = cpu_clock_secs();
+        cc = plat_get_cycle();
+
+        for (i = 0; i < iter; i++) {
+            for (j = 0; j < calls; j++) {
+                rng_buf_read(&rb, buf, len);
+            }
+        }
+        cc = plat_get_cycle() - cc;
+        ts = cpu_clock_secs() - ts;
+    } while (ts < to);
+    printf("%s\t%s randombytes %2u x %3zu %-9s %-8s:\t%8.3f us\t%8.3f kcyc\n",
+           CRYPTO_ALGNAME, label, (unsigned) calls, len, src,
+           sz > 0 ? "buffered" : "direct", 1E6 * ts / ((double)iter),
+           1E-3 * ((double)(cc / iter)));
+}
+
+//  Stack use of the *_ws functions: run one on a thread whose stack is
+//  painted and find the deepest overwritten byte.
+
+#define STACK_TEST_SZ   (256 * 1024)
+#define STACK_PAINT     0x5A
+
+typedef struct {
+    const sparrow_kem_t *kem;
+    int op;                         //  0: keygen, 1: encaps, 2: decaps,
+                                    //  3: decaps_batch (of one),
+                                    //  4, 5: encaps, decaps with pkp
+    uint8_t *pk, *sk, *ct, *k, *ws;
+    uint8_t *pkp;                   //  pk prepared by prepare_pk()
+    uint8_t *entry;                 //  stack address at thread entry
+    int ret;
+} stack_test_t;
+
+static void *stack_test_run(void *arg)
+{
+    stack_test_t *st = (stack_test_t *) arg;
+    volatile uint8_t top = 0;
+
+    st->entry = (uint8_t *) &top;
+    if (st->op == 0)
+        st->ret = st->kem->keypair_ws(st->pk, st->sk, 0, st->ws);
+    else if (st->op == 1)
+        st->ret = st->kem->encaps_ws(st->k, st->ct, st->pk, st->sk, st->ws);
+    else if (st->op == 2)
+        st->ret = st->kem->decaps_ws(st->k, st->ct, st->pk, st->sk, st->ws);
+    else if (st->op == 3)
+        st->ret = st->kem->decaps_batch_ws(st->k, st->ct, st->pk, st->sk, 1,
+                                           st->ws);
+    else if (st->op == 4)
+        st->ret = st->kem->encaps_pkp_ws(st->k, st->ct, st->pkp, st->sk,
+                                         st->ws);
+    else
+        st->ret = st->kem->decaps_pkp_ws(st->k, st->ct, st->pkp, st->sk,
+                                         st->ws);
+
+    return NULL;
+}
+
+//  Bytes of stack used by operation "st->op", or 0 on error.
+
+static size_t stack_test(stack_test_t *st, uint8_t *stk)
+{
+    size_t i;
+    pthread_t th;
+    pthread_attr_t attr;
+
+    memset(stk, STACK_PAINT, STACK_TEST_SZ);
+    if (pthread_attr_init(&attr) != 0 ||
+        pthread_attr_setstack(&attr, stk, STACK_TEST_SZ) != 0 ||
+        pthread_create(&th, &attr, stack_test_run, st) != 0)
+        return 0;
+    pthread_join(th, NULL);
+    pthread_attr_destroy(&attr);
+
+    for (i = 0; i < STACK_TEST_SZ && stk[i] == STACK_PAINT; i++)
+        ;
+    return st->ret == 0 ? (size_t) (st->entry - (stk + i)) : 0;
+}
+
+//  Result of a check, counted in test_fails: main() exits with 1 if any
+//  check failed.
+
+static int test_fails = 0;
+
+static const char *test_res(int ok)
+{
+    test_fails += !ok;
+    return ok ? "ok" : "not ok";
+}
+
+//  Kernels against their reference composition: each check draws one
+//  random input, runs both, and returns nonzero if the outputs differ.
+
+static void ref_rand_q(int64_t *v)
+{
+    size_t i;
+
+    randombytes((uint8_t *) v, SPARROW_N * sizeof(int64_t));
+    for (i = 0; i < SPARROW_N; i++) {
+        v[i] = (uint64_t) v[i] % SPARROW_Q;
+    }
+}
+
+//  small-coefficient multiplication: the NTT product
+
+static int ref_small_mula(void)
+{
+    int64_t a[SPARROW_N], s[SPARROW_N], c[SPARROW_N];
+    int64_t r0[SPARROW_N], r1[SPARROW_N], zero[SPARROW_N];
+
+    ref_rand_q(a);
+    ref_rand_q(c);
+    small_sample_gauss_vector(s, SPARROW_N);
+    polyr_small_mula(r0, a, s, c);
+
+    polyr_zero(zero);
+    polyr_fntt(a);
+    polyr_fntt(s);
+    polyr_ntt_mula(r1, a, s, zero);
+    polyr_intt(r1);
+    polyr_addq(r1, r1, c);
+
+    return memcmp(r0, r1, sizeof(r0));
+}
+
+//  fused encaps output: intt, addq, the hints and rec_vec
+
+static int ref_intt_help(void)
+{
+    size_t i;
+    int64_t v0[SPARROW_N], v1[SPARROW_N], y[SPARROW_N];
+    uint64_t r[REC_RAND_WORDS];
+    uint8_t k0[SPARROW_K_SZ], k1[SPARROW_K_SZ], h[SPARROW_CTBITS];
+    racc_ciphertext_t ct;
+
+    ref_rand_q(v0);
+    polyr_copy(v1, v0);
+    large_sample_gauss_vector(y, SPARROW_N);
+    help_rand(r);
+    polyr_intt_help(k0, h, v0, y, r);
+
+    polyr_intt(v1);
+    polyr_addq(v1, v1, y);
+    for (i = 0; i < SPARROW_CTBITS; i++) {
+        int x = (r[i / 32] >> (2 * (i % 32))) & 3;
+        ct.ct[i] = help_rec(2 * v1[i] + (x & 1) - (x >> 1));
+    }
+    rec_vec(k1, v1, &ct);
+
+    return memcmp(h, ct.ct, sizeof(h)) | memcmp(k0, k1, sizeof(k0));
+}
+
+//  fused decaps output: intt, addq and rec_vec with random hints
+
+static int ref_intt_rec(void)
+{
+    size_t i;
+    int64_t v0[SPARROW_N], v1[SPARROW_N], y[SPARROW_N];
+    uint8_t k0[SPARROW_K_SZ], k1[SPARROW_K_SZ], h[SPARROW_CTBITS];
+    racc_ciphertext_t ct;
+
+    ref_rand_q(v0);
+    polyr_copy(v1, v0);
+    large_sample_gauss_vector(y, SPARROW_N);
+    randombytes(h, sizeof(h));
+    for (i = 0; i < SPARROW_CTBITS; i++) {
+        ct.ct[i] = h[i] &= 1;
+    }
+    polyr_intt_rec(k0, v0, y, h);
+
+    polyr_intt(v1);
+    polyr_addq(v1, v1, y);
+    rec_vec(k1, v1, &ct);
+
+    return memcmp(k0, k1, sizeof(k0));
+}
+
+typedef struct {
+    const char *name;
+    int (*run)(void);
+} ref_check_t;
+
+static const ref_check_t ref_checks[] = {
+    { "polyr_small_mula",   ref_small_mula  },
+    { "polyr_intt_help",    ref_intt_help   },
+    { "polyr_intt_rec",     ref_intt_rec    },
+};
+
+#define REF_CHECKS (sizeof(ref_checks) / sizeof(ref_checks[0]))
+
 int main()
 {
     size_t i;
 
     //  timing
-    size_t iter = 100;
-    double ts, to;
-    uint64_t cc;
+    double to;
 
     //  buffers for serialized
     uint8_t K[CRYPTO_SHAREDKEY] = {0};
@@ -90,6 +307,7 @@ int main()
     printf("CRYPTO_SECRETKEYBYTES\t= %d\n", CRYPTO_SECRETKEYBYTES);
     printf("CRYPTO_BYTES\t\t= %d\n", CRYPTO_BYTES);
     printf("CRYPTO_SHAREDKEY\t\t= %d\n", CRYPTO_SHAREDKEY);
+    printf("SPARROW_CPU\t\t= %s\n", plat_cpu_name(plat_cpu_level()));
 
     //  === keygen ===
     crypto_sign_keypair(pkA, skA, 0);
@@ -125,109 +343,195 @@ int main()
         test += 1 - ok;
     }
     printf("nb encaps not ok: %d\n", test);
+    test_fails += test != 0;
 
-#ifdef BENCH_TIMEOUT
-    to = BENCH_TIMEOUT;
-#else
-    to = 1.0;  //   timeout threshold (seconds)
-#endif
-
-    printf("=== Bench ===\n");
-
-    int64_t y[SPARROW_N * SPARROW_K];
-    iter = 16;
-    do
+    //  implicit rejection: a wrong t gives a fixed key unrelated to K
     {
-        iter *= 2;
-        ts = cpu_clock_secs();
-        cc = plat_get_cycle();
+        uint8_t K_rej[CRYPTO_SHAREDKEY];
+        int r0, r1;
+
+        ct[CRYPTO_BYTES - 1] ^= 1;
+        r0 = crypto_decaps(K_, ct, pkB, skA);
+        r1 = crypto_decaps(K_rej, ct, pkB, skA);
+        ct[CRYPTO_BYTES - 1] ^= 1;
+        printf("implicit rejection: %s\n", test_res(r0 == 0 && r1 == 0 &&
+               memcmp(K_, K_rej, CRYPTO_SHAREDKEY) == 0 &&
+               memcmp(K_, K, CRYPTO_SHAREDKEY) != 0));
+    }
 
-        for (i = 0; i < iter; i++)
-        {
-            small_sample_gauss_vector(y, SPARROW_N * SPARROW_K);
+    //  kernels against their reference composition
+    for (i = 0; i < REF_CHECKS; i++) {
+        test = 0;
+        for (int j = 0; j < 100; j++) {
+            test += ref_checks[i].run() != 0;
         }
-        cc = plat_get_cycle() - cc;
-        ts = cpu_clock_secs() - ts;
-    } while (ts < to);
-    printf("%s\tSmallSampleGauss() %5zu:\t%8.3f ms\t%8.3f Mcyc\n", CRYPTO_ALGNAME, iter,
-           1000.0 * ts / ((double)iter), 1E-6 * ((double)(cc / iter)));
-
-
-    iter = 16;
-    do
-    {
-        iter *= 2;
-        ts = cpu_clock_secs();
-        cc = plat_get_cycle();
+        printf("%s vs. reference: %s\n", ref_checks[i].name,
+               test_res(test == 0));
+    }
 
-        for (i = 0; i < iter; i++)
-        {
-            large_sample_gauss_vector(y, SPARROW_CTBITS);
+    //  every compiled parameter set through the runtime table
+    for (i = 0; i < sparrow_kem_count(); i++) {
+        const sparrow_kem_t *kem = sparrow_kem_get(i);
+        uint8_t *buf = calloc(2 * (kem->pk_sz + kem->sk_sz) + kem->ct_sz +
+                              2 * kem->k_sz, 1);
+        uint8_t *pk0 = buf, *sk0 = pk0 + kem->pk_sz;
+        uint8_t *pk1 = sk0 + kem->sk_sz, *sk1 = pk1 + kem->pk_sz;
+        uint8_t *ct0 = sk1 + kem->sk_sz;
+        uint8_t *k0 = ct0 + kem->ct_sz, *k1 = k0 + kem->k_sz;
+        uint64_t *pkp = malloc(2 * kem->pkp_sz);    //  prepared pk0, pk1
+        void *pkp0 = pkp, *pkp1 = (uint8_t *) pkp + kem->pkp_sz;
+
+        test = 0;
+        for (int j = 0; j < 100; j++) {
+            kem->keypair(pk0, sk0, 0);
+            kem->keypair(pk1, sk1, 1);
+            kem->encaps(k0, ct0, pk0, sk1);
+            test += kem->decaps(k1, ct0, pk1, sk0) != 0 ||
+                    memcmp(k0, k1, kem->k_sz) != 0;
+            //  the same with prepared public keys
+            test += kem->prepare_pk(pkp0, pk0) != 0 ||
+                    kem->prepare_pk(pkp1, pk1) != 0;
+            test += kem->decaps_pkp(k1, ct0, pkp1, sk0) != 0 ||
+                    memcmp(k0, k1, kem->k_sz) != 0;
+            kem->encaps_pkp(k0, ct0, pkp0, sk1);
+            test += kem->decaps(k1, ct0, pk1, sk0) != 0 ||
+                    memcmp(k0, k1, kem->k_sz) != 0;
         }
-        cc = plat_get_cycle() - cc;
-        ts = cpu_clock_secs() - ts;
-    } while (ts < to);
-    printf("%s\tLargeSampleGauss() %5zu:\t%8.3f ms\t%8.3f Mcyc\n", CRYPTO_ALGNAME, iter,
-           1000.0 * ts / ((double)iter), 1E-6 * ((double)(cc / iter)));
-
-    iter = 16;
-    do {
-        iter *= 2;
-        ts = cpu_clock_secs();
-        cc = plat_get_cycle();
+        printf("%s\tpk %zu sk %zu ct %zu K %zu\tnot ok: %d\n", kem->name,
+               kem->pk_sz, kem->sk_sz, kem->ct_sz, kem->k_sz, test);
+        test_fails += test != 0;
+        free(pkp);
+        free(buf);
+    }
 
-        for (i = 0; i < iter; i++) {
-            crypto_sign_keypair(pkA, skA, 0);
+    //  batch decapsulation: the keys of encaps, and the implicit rejection
+    //  key of crypto_decaps() for the one ciphertext with a wrong t
+#define BATCH_TEST_N 8
+    for (i = 0; i < sparrow_kem_count(); i++) {
+        const sparrow_kem_t *kem = sparrow_kem_get(i);
+        const size_t n = BATCH_TEST_N;
+        uint8_t *buf = calloc((n + 1) * (kem->pk_sz + kem->sk_sz) +
+                              n * (kem->ct_sz + 2 * kem->k_sz), 1);
+        uint8_t *pk0 = buf, *sk0 = pk0 + kem->pk_sz, *pk1 = sk0 + kem->sk_sz;
+        uint8_t *sk1 = pk1 + n * kem->pk_sz, *ct1 = sk1 + n * kem->sk_sz;
+        uint8_t *k0 = ct1 + n * kem->ct_sz, *k1 = k0 + n * kem->k_sz;
+        size_t j, bad = 3;
+        int ret;
+
+        kem->keypair(pk0, sk0, 0);
+        for (j = 0; j < n; j++) {
+            kem->keypair(pk1 + j * kem->pk_sz, sk1 + j * kem->sk_sz, 1);
+            kem->encaps(k0 + j * kem->k_sz, ct1 + j * kem->ct_sz, pk0,
+                        sk1 + j * kem->sk_sz);
         }
-        cc = plat_get_cycle() - cc;
-        ts = cpu_clock_secs() - ts;
-    } while (ts < to);
-    printf("%s\tKeyGen() %5zu:\t%8.3f ms\t%8.3f Mcyc\n", CRYPTO_ALGNAME, iter,
-           1000.0 * ts / ((double)iter), 1E-6 * ((double) (cc / iter)));
-
-    iter = 16;
-    do
-    {
-        iter *= 2;
-
-        crypto_sign_keypair(pkA, skA, 0);
-        crypto_sign_keypair(pkB, skB, 1);
-
-        ts = cpu_clock_secs();
-        cc = plat_get_cycle();
+        ct1[(bad + 1) * kem->ct_sz - 1] ^= 1;
+        kem->decaps(k0 + bad * kem->k_sz, ct1 + bad * kem->ct_sz,
+                    pk1 + bad * kem->pk_sz, sk0);
+        ret = kem->decaps_batch(k1, ct1, pk1, sk0, n);
+        printf("%s\tdecaps_batch of %zu: %s\n", kem->name, n,
+               test_res(ret == 0 && memcmp(k0, k1, n * kem->k_sz) == 0));
+        free(buf);
+    }
 
-        for (i = 0; i < iter; i++)
-        {
-            crypto_encaps(K, ct, pkA, skB);
+    //  stack use with caller-provided working memory
+    uint8_t *stk = aligned_alloc(4096, STACK_TEST_SZ);
+    for (i = 0; i < sparrow_kem_count(); i++) {
+        const sparrow_kem_t *kem = sparrow_kem_get(i);
+        const char *op_name[6] = { "KeyGen_ws", "Encaps_ws", "Decaps_ws",
+                                   "Decaps_batch_ws", "Encaps_pkp_ws",
+                                   "Decaps_pkp_ws" };
+        size_t buf_sz = kem->batch_ws_sz + kem->pkp_sz + kem->pk_sz +
+                        kem->sk_sz + kem->ct_sz + kem->k_sz;
+        uint8_t *buf = sparrow_sec_alloc(buf_sz);
+        stack_test_t st;
+        size_t used;
+
+        st.kem = kem;
+        st.ws = buf;
+        st.pkp = st.ws + kem->batch_ws_sz;
+        st.pk = st.pkp + kem->pkp_sz;
+        st.sk = st.pk + kem->pk_sz;
+        st.ct = st.sk + kem->sk_sz;
+        st.k = st.ct + kem->ct_sz;
+        for (st.op = 0; st.op < 6; st.op++) {
+            if (st.op == 4)
+                kem->prepare_pk(st.pkp, st.pk);
+            used = stack_test(&st, stk);
+            printf("%s\t%s() stack %5zu (max %zu, ws %zu)\t%s\n", kem->name,
+                   op_name[st.op], used, kem->stack_sz,
+                   st.op == 3 ? kem->batch_ws_sz : kem->ws_sz,
+                   test_res(used > 0 && used <= kem->stack_sz));
         }
-        cc = plat_get_cycle() - cc;
-        ts = cpu_clock_secs() - ts;
-    } while (ts < to);
-    printf("%s\t  Encaps() %5zu:\t%8.3f ms\t%8.3f Mcyc\n", CRYPTO_ALGNAME, iter,
-           1000.0 * ts / ((double)iter), 1E-6 * ((double)(cc / iter)));
-
-    iter = 16;
-    do
-    {
-        iter *= 2;
-
-        crypto_sign_keypair(pkA, skA, 0);
-        crypto_sign_keypair(pkB, skB, 1);
+        sparrow_sec_free(buf, buf_sz);
+    }
+    free(stk);
 
-        ts = cpu_clock_secs();
-        cc = plat_get_cycle();
+#ifdef BENCH_TIMEOUT
+    to = BENCH_TIMEOUT;
+#else
+    to = 1.0;  //   timeout threshold (seconds)
+#endif
 
-        for (i = 0; i < iter; i++)
-        {
+    //  (xbench times the kernels and operations)
+    printf("=== Cost per operation ===\n");
+
+    //  randombytes() cost per operation: count the requests of each, then
+    //  replay them (xbench has the wiping cost)
+    const char *op_name[3] = { "KeyGen", "Encaps", "Decaps" };
+    uint64_t op_calls[3], op_bytes[3];
+    aes256_ctr_drbg_t aes_drbg;
+    sys_drbg_t shake_drbg;
+    rng_buf_t *rb = randombytes_buf();
+
+    for (i = 0; i < 3; i++) {
+        rb->calls = 0;
+        rb->bytes = 0;
+        if (i == 0)
+            crypto_sign_keypair(pkA, skA, 0);
+        else if (i == 1)
+            crypto_encaps(K, ct, pkA, skB);
+        else
             crypto_decaps(K, ct, pkB, skA);
+        op_calls[i] = rb->calls;
+        op_bytes[i] = rb->bytes;
+    }
+    aes256ctr_xof_init(&aes_drbg, seed);
+    sys_drbg_init(&shake_drbg);
+    for (i = 0; i < 3; i++) {
+        bench_rng(op_name[i], op_calls[i], op_bytes[i],
+                  "aes-drbg", aes256ctr_xof, &aes_drbg, 0, to);
+        bench_rng(op_name[i], op_calls[i], op_bytes[i],
+                  "aes-drbg", aes256ctr_xof, &aes_drbg, RNG_BUF_SZ, to);
+        bench_rng(op_name[i], op_calls[i], op_bytes[i],
+                  "getrandom", sys_getrandom, NULL, 0, to);
+        bench_rng(op_name[i], op_calls[i], op_bytes[i],
+                  "shake", sys_drbg_fill, &shake_drbg, RNG_BUF_SZ, to);
+    }
+
+#ifdef SPARROW_PROF
+    //  cycles per stage of each operation
+    for (i = 0; i < 3; i++) {
+        size_t j, iter = 1000;
+
+        prof_reset();
+        for (j = 0; j < iter; j++) {
+            if (i == 0)
+                crypto_sign_keypair(pkA, skA, 0);
+            else if (i == 1)
+                crypto_encaps(K, ct, pkA, skB);
+            else
+                crypto_decaps(K, ct, pkB, skA);
         }
-        cc = plat_get_cycle() - cc;
-        ts = cpu_clock_secs() - ts;
-    } while (ts < to);
-    printf("%s\t  Decaps() %5zu:\t%8.3f ms\t%8.3f Mcyc\n", CRYPTO_ALGNAME, iter,
-           1000.0 * ts / ((double)iter), 1E-6 * ((double)(cc / iter)));
+        prof_report(stdout, op_name[i], iter);
+    }
+#else
+    printf("(stage profile: build with RACCF=-DSPARROW_PROF)\n");
+#endif
+
+    if (test_fails != 0)
+        printf("=== %d checks not ok ===\n", test_fails);
 
-    return 0;
+    return test_fails != 0;
 }
 
 // NIST_KAT
@@ -0,0 +1,121 @@
+//  gen_ring.c
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Generate the NTT twiddle tables (ntt64_tab.h) for a parameter set.
+//  Compiled and run by the Makefile with -D<set>. Uses the root of unity
+//  of scripts/gen_ring.py, but emits Shoup pairs instead of Montgomery form.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "sparrow_param.h"
+
+//  number of Shoup quotient bits: w' = floor(w * 2^SHOUP_K / q)
+#define SHOUP_K 32
+
+static uint64_t mulmod(uint64_t a, uint64_t b, uint64_t q)
+{
+    return (uint64_t)(((unsigned __int128)a * b) % q);
+}
+
+static uint64_t powmod(uint64_t x, uint64_t e, uint64_t q)
+{
+    uint64_t y = 1;
+
+    while (e > 0) {
+        if (e & 1)
+            y = mulmod(y, x, q);
+        x = mulmod(x, x, q);
+        e >>= 1;
+    }
+    return y;
+}
+
+//  multiplicative order of x mod prime q
+
+static uint64_t order(uint64_t x, uint64_t q)
+{
+    uint64_t m, f, p;
+
+    m = q - 1;
+    f = q - 1;
+    for (p = 2; f > 1; p++) {
+        if (f % p != 0)
+            continue;
+        while (f % p == 0)
+            f /= p;
+        while (m % p == 0 && powmod(x, m / p, q) == 1)
+            m /= p;
+    }
+    return m;
+}
+
+//  bit-reverse "x" of "l" bits
+
+static uint64_t bitrev(uint64_t x, int l)
+{
+    int i;
+    uint64_t y = 0;
+
+    for (i = 0; i < l; i++) {
+        y |= ((x >> i) & 1) << (l - i - 1);
+    }
+    return y;
+}
+
+int main(void)
+{
+    const uint64_t q = SPARROW_Q;
+    const uint64_t n = SPARROW_N;
+    uint64_t x, m, h, r, s, w, i;
+
+    if ((q - 1) % (2 * n) != 0) {
+        fprintf(stderr, "gen_ring: 2n does not divide q - 1\n");
+        return 1;
+    }
+
+    //  smallest x > 1 whose order is a multiple of 2n (as gen_ring.py)
+    for (x = 2; (m = order(x, q)) % (2 * n) != 0; x++)
+        ;
+    h = powmod(x, m / (2 * n), q);
+    if (powmod(h, n, q) != q - 1) {
+        fprintf(stderr, "gen_ring: h is not a primitive 2n-th root\n");
+        return 1;
+    }
+
+    //  r = 2^64 mod q
+    r = (uint64_t)((((unsigned __int128)1) << 64) % q);
+
+    printf("//  ntt64_tab.h\n"
+           "//  Generated by tools/gen_ring.c for %s -- do not edit.\n\n"
+           "//  n = %llu, q = %llu, h = %llu (root of order 2n)\n\n",
+           SPARROW_NAME, (unsigned long long)n, (unsigned long long)q,
+           (unsigned long long)h);
+
+    printf("//  Shoup pairs { w, floor(w * 2^%d / q) }, w = h^bitrev(i)\n\n"
+           "#define SPARROW_SHOUP_K %d\n\n"
+           "static const int64_t sparrow_wsh_64[%llu][2] = {\n",
+           SHOUP_K, SHOUP_K, (unsigned long long)(n - 1));
+    for (i = 1; i < n; i++) {
+        w = powmod(h, bitrev(i, SPARROW_LGN), q);
+        printf("\t{ %10llu, %12llu },\n", (unsigned long long)w,
+               (unsigned long long)((((unsigned __int128)w) << SHOUP_K) / q));
+    }
+    printf("};\n\n");
+
+    //  s = 2^64 / n mod q; 1/n = q - (q - 1)/n (mod q)
+    s = mulmod(r, q - (q - 1) / n, q);
+    w = mulmod(powmod(h, bitrev(1, SPARROW_LGN), q), s, q);
+
+    printf("//  Last inverse layer with the normalization by 2^64 / n merged:\n"
+           "//  { s, s' }, { w * s, (w * s)' }, s = 2^64 / n, w = h^bitrev(1)\n\n"
+           "static const int64_t sparrow_wsh_ni[2][2] = {\n");
+    printf("\t{ %10llu, %12llu },\n", (unsigned long long)s,
+           (unsigned long long)((((unsigned __int128)s) << SHOUP_K) / q));
+    printf("\t{ %10llu, %12llu },\n", (unsigned long long)w,
+           (unsigned long long)((((unsigned __int128)w) << SHOUP_K) / q));
+    printf("};\n");
+
+    return 0;
+}
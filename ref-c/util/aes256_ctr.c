@@ -0,0 +1,259 @@
+//  aes256_ctr.c
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === AES-256 counter mode keystream for the DRBG (nist_random.c).
+//  AES-NI and VAES backends pipeline 8 counter blocks; the table-based
+//  aes1kt256 (not constant time) remains the portable fallback.
+
+//  the original NIST generator uses OpenSSL instead
+#ifndef NIST_KAT
+
+#include "aes256_ctr.h"
+#include "plat_cpu.h"
+
+#ifdef PLAT_CPU_X64
+#include <immintrin.h>
+#endif
+
+//  === Portable backend
+
+//  increment the 128-bit big-endian counter (not constant time)
+
+static inline void aes256_ctr_inc(uint8_t ctr[16])
+{
+    int i;
+    uint32_t x;
+
+    x = 1;
+
+    for (i = 15; i >= 0; i--) {
+        x += (uint32_t)ctr[i];
+        ctr[i] = (uint8_t)x;
+        x >>= 8;
+    }
+}
+
+static void aes256_ctr_blocks_ref(uint8_t *out, uint8_t ctr[16], size_t nb,
+                                  const uint32_t rk[AES256_RK_WORDS])
+{
+    size_t i;
+
+    for (i = 0; i < nb; i++) {
+        aes256_ctr_inc(ctr);
+        aes1kt256_enc_ecb(out, ctr, rk);
+        out += 16;
+    }
+}
+
+#ifdef PLAT_CPU_X64
+
+//  === AES-NI backend
+
+//  w[0] ^ w[1] ^ .. prefix of the key words in "a", xor "b"
+
+PLAT_TARGET_AESNI
+static inline __m128i aes256_key_exp(__m128i a, __m128i b)
+{
+    a = _mm_xor_si128(a, _mm_slli_si128(a, 4));
+    a = _mm_xor_si128(a, _mm_slli_si128(a, 8));
+    return _mm_xor_si128(a, b);
+}
+
+//  even round keys use SubWord(RotWord()) ^ rcon, odd ones SubWord()
+
+#define AES256_KEY_A(k, i, rc) k[i] = aes256_key_exp(k[i - 2], \
+    _mm_shuffle_epi32(_mm_aeskeygenassist_si128(k[i - 1], rc), 0xFF))
+#define AES256_KEY_B(k, i) k[i] = aes256_key_exp(k[i - 2], \
+    _mm_shuffle_epi32(_mm_aeskeygenassist_si128(k[i - 1], 0x00), 0xAA))
+
+PLAT_TARGET_AESNI
+static void aes256_ctr_key_aesni(uint32_t rk[AES256_RK_WORDS],
+                                 const uint8_t key[32])
+{
+    int i;
+    __m128i k[AES256_ROUNDS + 1];
+
+    k[0] = _mm_loadu_si128((const __m128i *)key);
+    k[1] = _mm_loadu_si128((const __m128i *)(key + 16));
+    AES256_KEY_A(k, 2, 0x01);   AES256_KEY_B(k, 3);
+    AES256_KEY_A(k, 4, 0x02);   AES256_KEY_B(k, 5);
+    AES256_KEY_A(k, 6, 0x04);   AES256_KEY_B(k, 7);
+    AES256_KEY_A(k, 8, 0x08);   AES256_KEY_B(k, 9);
+    AES256_KEY_A(k, 10, 0x10);  AES256_KEY_B(k, 11);
+    AES256_KEY_A(k, 12, 0x20);  AES256_KEY_B(k, 13);
+    AES256_KEY_A(k, 14, 0x40);
+
+    for (i = 0; i <= AES256_ROUNDS; i++) {
+        _mm_storeu_si128((__m128i *)(rk + 4 * i), k[i]);
+    }
+}
+
+//  encrypt "n" <= 8 counter blocks; (hi, lo) is the counter
+
+PLAT_TARGET_AESNI
+static inline __attribute__((always_inline))
+void aes256_ctr_x8_aesni(uint8_t *out, uint64_t *hi, uint64_t *lo, size_t n,
+                         const __m128i k[AES256_ROUNDS + 1])
+{
+    size_t i, r;
+    __m128i b[8];
+    const __m128i bswap = _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15,
+                                       0, 1, 2, 3, 4, 5, 6, 7);
+
+    for (i = 0; i < n; i++) {
+        *lo += 1;
+        *hi += (*lo == 0);
+        b[i] = _mm_shuffle_epi8(_mm_set_epi64x(*lo, *hi), bswap);
+        b[i] = _mm_xor_si128(b[i], k[0]);
+    }
+    for (r = 1; r < AES256_ROUNDS; r++) {
+        for (i = 0; i < n; i++) {
+            b[i] = _mm_aesenc_si128(b[i], k[r]);
+        }
+    }
+    for (i = 0; i < n; i++) {
+        b[i] = _mm_aesenclast_si128(b[i], k[AES256_ROUNDS]);
+        _mm_storeu_si128((__m128i *)(out + 16 * i), b[i]);
+    }
+}
+
+PLAT_TARGET_AESNI
+static void aes256_ctr_blocks_aesni(uint8_t *out, uint8_t ctr[16], size_t nb,
+                                    const uint32_t rk[AES256_RK_WORDS])
+{
+    size_t i;
+    uint64_t hi, lo;
+    __m128i k[AES256_ROUNDS + 1];
+
+    for (i = 0; i <= AES256_ROUNDS; i++) {
+        k[i] = _mm_loadu_si128((const __m128i *)(rk + 4 * i));
+    }
+    hi = get64u_be(ctr);
+    lo = get64u_be(ctr + 8);
+
+    for (; nb >= 8; nb -= 8) {
+        aes256_ctr_x8_aesni(out, &hi, &lo, 8, k);
+        out += 8 * 16;
+    }
+    if (nb > 0) {
+        aes256_ctr_x8_aesni(out, &hi, &lo, nb, k);
+    }
+
+    put64u_be(ctr, hi);
+    put64u_be(ctr + 8, lo);
+}
+
+//  === VAES backend (4 blocks per 512-bit vector)
+
+PLAT_TARGET_VAES
+static void aes256_ctr_blocks_vaes(uint8_t *out, uint8_t ctr[16], size_t nb,
+                                   const uint32_t rk[AES256_RK_WORDS])
+{
+    size_t i;
+    uint64_t hi, lo, h[8], l[8];
+    __m512i k[AES256_ROUNDS + 1], b0, b1;
+    const __m512i bswap = _mm512_broadcast_i32x4(
+        _mm_set_epi8(8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7));
+
+    for (i = 0; i <= AES256_ROUNDS; i++) {
+        k[i] = _mm512_broadcast_i32x4(
+                    _mm_loadu_si128((const __m128i *)(rk + 4 * i)));
+    }
+    hi = get64u_be(ctr);
+    lo = get64u_be(ctr + 8);
+
+    for (; nb >= 8; nb -= 8) {
+        for (i = 0; i < 8; i++) {
+            lo += 1;
+            hi += (lo == 0);
+            h[i] = hi;
+            l[i] = lo;
+        }
+        b0 = _mm512_set_epi64(l[3], h[3], l[2], h[2], l[1], h[1], l[0], h[0]);
+        b1 = _mm512_set_epi64(l[7], h[7], l[6], h[6], l[5], h[5], l[4], h[4]);
+        b0 = _mm512_xor_si512(_mm512_shuffle_epi8(b0, bswap), k[0]);
+        b1 = _mm512_xor_si512(_mm512_shuffle_epi8(b1, bswap), k[0]);
+        for (i = 1; i < AES256_ROUNDS; i++) {
+            b0 = _mm512_aesenc_epi128(b0, k[i]);
+            b1 = _mm512_aesenc_epi128(b1, k[i]);
+        }
+        b0 = _mm512_aesenclast_epi128(b0, k[AES256_ROUNDS]);
+        b1 = _mm512_aesenclast_epi128(b1, k[AES256_ROUNDS]);
+        _mm512_storeu_si512((void *)out, b0);
+        _mm512_storeu_si512((void *)(out + 64), b1);
+        out += 8 * 16;
+    }
+
+    put64u_be(ctr, hi);
+    put64u_be(ctr + 8, lo);
+
+    //  tail
+    if (nb > 0) {
+        aes256_ctr_blocks_aesni(out, ctr, nb, rk);
+    }
+}
+
+#else
+#define aes256_ctr_key_aesni    aes1kt256_enc_key
+#define aes256_ctr_blocks_aesni aes256_ctr_blocks_ref
+#define aes256_ctr_blocks_vaes  aes256_ctr_blocks_ref
+//  PLAT_CPU_X64
+#endif
+
+//  === Runtime dispatch
+
+static void (*const aes256_ctr_key_tab[PLAT_CPU_LEVELS])
+            (uint32_t rk[AES256_RK_WORDS], const uint8_t key[32]) = {
+    aes1kt256_enc_key, aes256_ctr_key_aesni, aes256_ctr_key_aesni
+};
+
+static void (*const aes256_ctr_blocks_tab[PLAT_CPU_LEVELS])
+            (uint8_t *out, uint8_t ctr[16], size_t nb,
+             const uint32_t rk[AES256_RK_WORDS]) = {
+    aes256_ctr_blocks_ref, aes256_ctr_blocks_aesni, aes256_ctr_blocks_vaes
+};
+
+static const char *aes256_ctr_names[PLAT_CPU_LEVELS] = {
+    "table", "aes-ni", "vaes"
+};
+
+//  selected level, lowered to what the AES extensions allow
+
+static inline int aes256_ctr_level(void)
+{
+    int level, feat;
+
+    level = plat_cpu_level();
+    feat = plat_cpu_feat();
+    if (level >= PLAT_CPU_AVX512 && (feat & PLAT_CPU_F_VAES) == 0)
+        level = PLAT_CPU_AVX2;
+    if (level >= PLAT_CPU_AVX2 && (feat & PLAT_CPU_F_AESNI) == 0)
+        level = PLAT_CPU_PORTABLE;
+
+    return level;
+}
+
+//  Expand a 256-bit key.
+
+void aes256_ctr_key(uint32_t rk[AES256_RK_WORDS], const uint8_t key[32])
+{
+    aes256_ctr_key_tab[aes256_ctr_level()](rk, key);
+}
+
+//  Encrypt "nb" successive counter blocks into "out".
+
+void aes256_ctr_blocks(uint8_t *out, uint8_t ctr[16], size_t nb,
+                       const uint32_t rk[AES256_RK_WORDS])
+{
+    aes256_ctr_blocks_tab[aes256_ctr_level()](out, ctr, nb, rk);
+}
+
+//  Name of the backend in use.
+
+const char *aes256_ctr_name(void)
+{
+    return aes256_ctr_names[aes256_ctr_level()];
+}
+
+//  NIST_KAT
+#endif
@@ -3,6 +3,7 @@
 
 //  === Generic constant time utilities.
 
+#include <string.h>
 #include "ct_util.h"
 
 //  returns true for equal strings, false for non-equal strings
@@ -30,3 +31,40 @@ void ct_cmov(uint8_t *r, const uint8_t *x, size_t len, uint8_t b)
         r[i] ^= b & (x[i] ^ r[i]);
     }
 }
+
+#ifdef SPARROW_CT_STATS
+static _Thread_local ct_wipe_stat_t ct_wipe;
+#endif
+
+//  zeroize secret memory; the empty asm statement "reads" the cleared
+//  bytes, so the compiler (also with LTO) cannot drop the memset()
+
+void ct_memzero(void *p, size_t len)
+{
+#ifdef SPARROW_CT_STATS
+    ct_wipe.calls++;
+    ct_wipe.bytes += len;
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+    memset(p, 0x00, len);
+    __asm__ __volatile__ ("" : : "r"(p) : "memory");
+#else
+    volatile uint8_t *v = (volatile uint8_t *) p;
+    while (len--) {
+        *v++ = 0x00;
+    }
+#endif
+}
+
+#ifdef SPARROW_CT_STATS
+
+//  ct_memzero() calls and bytes in this thread
+
+ct_wipe_stat_t *ct_wipe_stat(void)
+{
+    return &ct_wipe;
+}
+
+//  SPARROW_CT_STATS
+#endif
@@ -6,6 +6,11 @@
 
 #include "keccakf1600.h"
 #include "plat_local.h"
+#include "plat_cpu.h"
+
+#ifdef PLAT_CPU_X64
+#include <immintrin.h>
+#endif
 
 //  clear the state
 
@@ -41,8 +46,10 @@ void keccak_xorbytes(uint64_t* vs, const uint8_t* data, size_t rate)
 }
 
 //  FIPS 202 Keccak f1600 permutation, 24 rounds -- Keccak-p[1600,24](S)
+//  (always inlined so that each backend below gets its own code generation)
 
-void keccak_f1600(uint64_t vs[25])
+static inline __attribute__((always_inline))
+void keccak_f1600_x(uint64_t vs[25])
 {
     //  round constants
     const uint64_t rc[24] = {
@@ -233,3 +240,175 @@ void keccak_f1600(uint64_t vs[25])
     vs[23] = sx;
     vs[24] = sy;
 }
+
+//  === Backends
+
+static void keccak_f1600_ref(uint64_t vs[25])
+{
+    keccak_f1600_x(vs);
+}
+
+#ifdef PLAT_CPU_X64
+
+//  A single Keccak state has no useful SIMD width; these are the same
+//  permutation compiled with BMI1/BMI2 (andn, rorx) and VEX encoding.
+
+PLAT_TARGET_AVX2
+static void keccak_f1600_avx2(uint64_t vs[25])
+{
+    keccak_f1600_x(vs);
+}
+
+PLAT_TARGET_AVX512
+static void keccak_f1600_avx512(uint64_t vs[25])
+{
+    keccak_f1600_x(vs);
+}
+
+#else
+#define keccak_f1600_avx2   keccak_f1600_ref
+#define keccak_f1600_avx512 keccak_f1600_ref
+#endif
+
+static void (*const keccak_f1600_tab[PLAT_CPU_LEVELS])(uint64_t vs[25]) = {
+    keccak_f1600_ref, keccak_f1600_avx2, keccak_f1600_avx512
+};
+
+//  FIPS 202 Keccak f1600 permutation, runtime dispatch.
+
+void keccak_f1600(uint64_t vs[25])
+{
+    keccak_f1600_tab[plat_cpu_level()](vs);
+}
+
+//  === Four-way permutation
+//  Four independent states with interleaved lanes: lane i of state j is
+//  vs[4 * i + j], so that one 256-bit vector holds the same lane of all
+//  four states.
+
+static const uint64_t keccak_x4_rc[24] = {
+    0x0000000000000001LL, 0x0000000000008082LL, 0x800000000000808ALL,
+    0x8000000080008000LL, 0x000000000000808BLL, 0x0000000080000001LL,
+    0x8000000080008081LL, 0x8000000000008009LL, 0x000000000000008ALL,
+    0x0000000000000088LL, 0x0000000080008009LL, 0x000000008000000ALL,
+    0x000000008000808BLL, 0x800000000000008BLL, 0x8000000000008089LL,
+    0x8000000000008003LL, 0x8000000000008002LL, 0x8000000000000080LL,
+    0x000000000000800ALL, 0x800000008000000ALL, 0x8000000080008081LL,
+    0x8000000000008080LL, 0x0000000080000001LL, 0x8000000080008008LL};
+
+//  rho rotations of lane x + 5 * y
+
+static const int keccak_x4_rho[25] = {
+     0,  1, 62, 28, 27,     36, 44,  6, 55, 20,     3, 10, 43, 25, 39,
+    41, 45, 15, 21,  8,     18,  2, 61, 56, 14 };
+
+static void keccak_f1600_x4_ref(uint64_t vs[4 * 25])
+{
+    size_t i, j;
+    uint64_t s[25];
+
+    for (j = 0; j < 4; j++) {
+        for (i = 0; i < 25; i++) {
+            s[i] = vs[4 * i + j];
+        }
+        keccak_f1600_x(s);
+        for (i = 0; i < 25; i++) {
+            vs[4 * i + j] = s[i];
+        }
+    }
+}
+
+#ifdef PLAT_CPU_X64
+
+//  One round on the vectors a[25] with the backend's KX4_ROL(x, n) and
+//  KX4_CHI(a, b, c) = a ^ (~b & c); the loops unroll to constant indices.
+
+#define KECCAK_X4_ROUND(a, r) {                                             \
+    __m256i c[5], d, b[25];                                                 \
+    int x, y;                                                               \
+    _Pragma("GCC unroll 5")                                                 \
+    for (x = 0; x < 5; x++) {                                               \
+        c[x] = _mm256_xor_si256(_mm256_xor_si256(a[x], a[x + 5]),           \
+               _mm256_xor_si256(_mm256_xor_si256(a[x + 10], a[x + 15]),     \
+                                a[x + 20]));                                \
+    }                                                                       \
+    _Pragma("GCC unroll 5")                                                 \
+    for (x = 0; x < 5; x++) {                                               \
+        d = _mm256_xor_si256(c[(x + 4) % 5], KX4_ROL(c[(x + 1) % 5], 1));   \
+        _Pragma("GCC unroll 5")                                             \
+        for (y = 0; y < 5; y++) {                                           \
+            b[y + 5 * ((2 * x + 3 * y) % 5)] = KX4_ROL(                     \
+                _mm256_xor_si256(a[x + 5 * y], d),                          \
+                keccak_x4_rho[x + 5 * y]);                                  \
+        }                                                                   \
+    }                                                                       \
+    _Pragma("GCC unroll 5")                                                 \
+    for (y = 0; y < 25; y += 5) {                                           \
+        _Pragma("GCC unroll 5")                                             \
+        for (x = 0; x < 5; x++) {                                           \
+            a[x + y] = KX4_CHI(b[x + y], b[(x + 1) % 5 + y],                \
+                               b[(x + 2) % 5 + y]);                         \
+        }                                                                   \
+    }                                                                       \
+    a[0] = _mm256_xor_si256(a[0], _mm256_set1_epi64x(keccak_x4_rc[r]));    \
+}
+
+#define KECCAK_X4_BODY(vs) {                                                \
+    __m256i a[25];                                                          \
+    int i, r;                                                               \
+    for (i = 0; i < 25; i++) {                                              \
+        a[i] = _mm256_loadu_si256((const __m256i *) (vs + 4 * i));          \
+    }                                                                       \
+    for (r = 0; r < 24; r++) {                                              \
+        KECCAK_X4_ROUND(a, r)                                               \
+    }                                                                       \
+    for (i = 0; i < 25; i++) {                                              \
+        _mm256_storeu_si256((__m256i *) (vs + 4 * i), a[i]);                \
+    }                                                                       \
+}
+
+//  AVX2: shifts for the rotations, andnot for chi.
+
+#define KX4_ROL(x, n)   ((n) == 0 ? (x) : _mm256_or_si256(                  \
+                        _mm256_slli_epi64(x, n), _mm256_srli_epi64(x, 64 - (n))))
+#define KX4_CHI(a, b, c) _mm256_xor_si256(a, _mm256_andnot_si256(b, c))
+
+PLAT_TARGET_AVX2
+static void keccak_f1600_x4_avx2(uint64_t vs[4 * 25])
+{
+    KECCAK_X4_BODY(vs)
+}
+
+#undef KX4_ROL
+#undef KX4_CHI
+
+//  AVX-512VL: native rotations, and chi as one ternary logic operation.
+
+#define KX4_ROL(x, n)   _mm256_rolv_epi64(x, _mm256_set1_epi64x(n))
+#define KX4_CHI(a, b, c) _mm256_ternarylogic_epi64(a, b, c, 0xD2)
+
+PLAT_TARGET_AVX512
+static void keccak_f1600_x4_avx512(uint64_t vs[4 * 25])
+{
+    KECCAK_X4_BODY(vs)
+}
+
+#undef KX4_ROL
+#undef KX4_CHI
+
+#else
+#define keccak_f1600_x4_avx2    keccak_f1600_x4_ref
+#define keccak_f1600_x4_avx512  keccak_f1600_x4_ref
+#endif
+
+static void (*const keccak_f1600_x4_tab[PLAT_CPU_LEVELS])
+            (uint64_t vs[4 * 25]) = {
+    keccak_f1600_x4_ref, keccak_f1600_x4_avx2, keccak_f1600_x4_avx512
+};
+
+//  Four FIPS 202 Keccak f1600 permutations, runtime dispatch.
+
+void keccak_f1600_x4(uint64_t vs[4 * 25])
+{
+    keccak_f1600_x4_tab[plat_cpu_level()](vs);
+}
@@ -13,68 +13,57 @@
 
 aes256_ctr_drbg_t aesdrbg_global_ctx = {0};
 
-//  (not constant time )
-
-static inline void aesdrbg_inc_ctr(uint8_t ctr[16])
-{
-    int i;
-    uint32_t x;
+#ifdef SPARROW_RNG_BUF
+#define NIST_RNG_BUF_SZ RNG_BUF_SZ
+#else
+#define NIST_RNG_BUF_SZ 0
+#endif
 
-    x = 1;
-
-    for (i = 15; i >= 0; i--) {
-        x += (uint32_t)ctr[i];
-        ctr[i] = (uint8_t)x;
-        x >>= 8;
-    }
-}
+rng_buf_t nist_rng_buf = {
+    aes256ctr_xof, &aesdrbg_global_ctx, NIST_RNG_BUF_SZ, NIST_RNG_BUF_SZ,
+    0, 0, {0}
+};
 
 static void aesdrbg_update(aes256_ctr_drbg_t *ctx, const uint8_t *input48)
 {
     size_t i;
     uint8_t tmp[48];
 
-    for (i = 0; i < 48; i += 16) {
-        aesdrbg_inc_ctr(ctx->ctr);
-        aes256_enc_ecb(tmp + i, ctx->ctr, ctx->rk);
-    }
+    aes256_ctr_blocks(tmp, ctx->ctr, 3, ctx->rk);
     if (input48 != NULL) {
         for (i = 0; i < 48; i++)
             tmp[i] ^= input48[i];
     }
     memcpy(ctx->key, tmp, 32);
     memcpy(ctx->ctr, tmp + 32, 16);
-    aes256_enc_key(ctx->rk, ctx->key);
+    aes256_ctr_key(ctx->rk, ctx->key);
 }
 
 void aes256ctr_xof_init(aes256_ctr_drbg_t *ctx, const uint8_t *input48)
 {
     memset(ctx->key, 0x00, 32);
     memset(ctx->ctr, 0x00, 16);
-    aes256_enc_key(ctx->rk, ctx->key);
+    aes256_ctr_key(ctx->rk, ctx->key);
 
     aesdrbg_update(ctx, input48);
 }
 
 int aes256ctr_xof(void *ctx, void *buf, size_t len)
 {
+    size_t nb;
     uint8_t tmp[16];
     aes256_ctr_drbg_t *drbg = ctx;
     uint8_t *x = buf;
 
-    while (len > 0) {
-        // increment ctr
-        aesdrbg_inc_ctr(drbg->ctr);
-        aes256_enc_ecb(tmp, drbg->ctr, drbg->rk);
-
-        if (len > 15) {
-            memcpy(x, tmp, 16);
-            x += 16;
-            len -= 16;
-        } else {
-            memcpy(x, tmp, len);
-            len = 0;
-        }
+    //  full blocks directly into the output, then a partial one
+    nb = len / 16;
+    aes256_ctr_blocks(x, drbg->ctr, nb, drbg->rk);
+    x += 16 * nb;
+    len -= 16 * nb;
+
+    if (len > 0) {
+        aes256_ctr_blocks(tmp, drbg->ctr, 1, drbg->rk);
+        memcpy(x, tmp, len);
     }
     aesdrbg_update(drbg, NULL);
 
@@ -98,13 +87,14 @@ void nist_randombytes_init(const uint8_t entropy_input[48],
     }
 
     aes256ctr_xof_init(&aesdrbg_global_ctx, entropy_input);
+    rng_buf_clear(&nist_rng_buf);
 }
 
 //  nist test vector generator
 
 int nist_randombytes(uint8_t *x, size_t xlen)
 {
-    return aes256ctr_xof(&aesdrbg_global_ctx, x, xlen);
+    return rng_buf_read(&nist_rng_buf, x, xlen);
 }
 
 //  NIST_KAT
@@ -0,0 +1,162 @@
+//  plat_cpu.c
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Runtime CPU feature detection and kernel backend selection.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "plat_cpu.h"
+
+#ifdef PLAT_CPU_X64
+#include <cpuid.h>
+#endif
+
+//  selected level (benign race: every thread computes the same value)
+
+int plat_cpu_sel = -1;
+
+static const char *plat_cpu_names[PLAT_CPU_LEVELS] = {
+    "portable", "avx2", "avx512"
+};
+
+#ifdef PLAT_CPU_X64
+
+//  read extended control register 0 (which register states the OS saves)
+
+static inline uint64_t plat_xgetbv0(void)
+{
+    uint32_t lo, hi;
+
+    asm volatile ("xgetbv" : "=a" (lo), "=d" (hi) : "c" (0));
+    return (((uint64_t) hi) << 32) | ((uint64_t) lo);
+}
+
+#endif
+
+//  Detect the highest level supported by this CPU (and operating system).
+
+static int plat_cpu_detect(void)
+{
+#ifdef PLAT_CPU_X64
+    uint32_t a, b, c, d;
+    uint64_t xcr0;
+    int avx2, avx512;
+
+    if (!__get_cpuid(1, &a, &b, &c, &d))
+        return PLAT_CPU_PORTABLE;
+
+    //  OSXSAVE and AVX
+    if ((c & bit_OSXSAVE) == 0 || (c & bit_AVX) == 0)
+        return PLAT_CPU_PORTABLE;
+
+    //  XMM and YMM state enabled by the OS
+    xcr0 = plat_xgetbv0();
+    if ((xcr0 & 0x06) != 0x06)
+        return PLAT_CPU_PORTABLE;
+
+    if (!__get_cpuid_count(7, 0, &a, &b, &c, &d))
+        return PLAT_CPU_PORTABLE;
+
+    avx2 = (b & bit_AVX2) && (b & bit_BMI) && (b & bit_BMI2);
+    if (!avx2)
+        return PLAT_CPU_PORTABLE;
+
+    //  AVX-512 F, DQ, BW, VL; opmask, ZMM_Hi256, Hi16_ZMM state
+    avx512 = (b & bit_AVX512F) && (b & bit_AVX512DQ) &&
+             (b & bit_AVX512BW) && (b & bit_AVX512VL) &&
+             ((xcr0 & 0xE0) == 0xE0);
+    if (!avx512)
+        return PLAT_CPU_AVX2;
+
+    return PLAT_CPU_AVX512;
+#else
+    return PLAT_CPU_PORTABLE;
+#endif
+}
+
+//  Highest level supported by this CPU (cached; cpuid is slow in VMs).
+
+int plat_cpu_max(void)
+{
+    static int max = -1;
+
+    if (max < 0)
+        max = plat_cpu_detect();
+    return max;
+}
+
+//  Extension flags PLAT_CPU_F_* supported by this CPU (cached).
+
+int plat_cpu_feat(void)
+{
+    static int feat = -1;
+#ifdef PLAT_CPU_X64
+    uint32_t a, b, c, d;
+    int f;
+
+    if (feat >= 0)
+        return feat;
+
+    f = 0;
+    if (__get_cpuid(1, &a, &b, &c, &d) && (c & bit_AES))
+        f |= PLAT_CPU_F_AESNI;
+
+    //  VAES is only used with the AVX-512 (ZMM) state, see plat_cpu_max()
+    if ((f & PLAT_CPU_F_AESNI) && plat_cpu_max() == PLAT_CPU_AVX512 &&
+        __get_cpuid_count(7, 0, &a, &b, &c, &d) && (c & bit_VAES))
+        f |= PLAT_CPU_F_VAES;
+
+    feat = f;
+#else
+    feat = 0;
+#endif
+    return feat;
+}
+
+//  Select a backend level at runtime, clamped to what the CPU supports.
+
+int plat_cpu_select(int level)
+{
+    int max;
+
+    max = plat_cpu_max();
+    if (level > max)
+        level = max;
+    if (level < PLAT_CPU_PORTABLE)
+        level = PLAT_CPU_PORTABLE;
+    plat_cpu_sel = level;
+
+    return level;
+}
+
+//  Detect the CPU, apply PLAT_CPU_ENV, and return the selected level.
+
+int plat_cpu_init(void)
+{
+    int i, level;
+    const char *env;
+
+    level = PLAT_CPU_LEVELS - 1;
+
+    env = getenv(PLAT_CPU_ENV);
+    if (env != NULL) {
+        for (i = 0; i < PLAT_CPU_LEVELS; i++) {
+            if (strcmp(env, plat_cpu_names[i]) == 0) {
+                level = i;
+                break;
+            }
+        }
+    }
+
+    return plat_cpu_select(level);
+}
+
+//  Human-readable backend name.
+
+const char *plat_cpu_name(int level)
+{
+    if (level < 0 || level >= PLAT_CPU_LEVELS)
+        return "unknown";
+    return plat_cpu_names[level];
+}
@@ -0,0 +1,60 @@
+//  plat_prof.c
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Optional per-stage cycle counters (build with -DSPARROW_PROF).
+
+#include <string.h>
+
+#include "plat_prof.h"
+
+#ifdef SPARROW_PROF
+static const char *prof_names[PROF_STAGES] = {
+    "decode", "encode", "xof", "ntt", "mula", "intt", "gauss", "rec", "hash"
+};
+#endif
+
+static _Thread_local prof_tab_t prof_thr;
+
+//  This thread's counters.
+
+prof_tab_t *prof_tab(void)
+{
+    return &prof_thr;
+}
+
+//  Zero this thread's counters.
+
+void prof_reset(void)
+{
+    memset(&prof_thr, 0, sizeof(prof_thr));
+}
+
+//  Print this thread's counters per operation to "f".
+
+void prof_report(FILE *f, const char *label, uint64_t ops)
+{
+#ifndef SPARROW_PROF
+    (void) ops;
+    fprintf(f, "%s\t(stage profile: build with RACCF=-DSPARROW_PROF)\n",
+            label);
+#else
+    int i;
+    uint64_t sum;
+
+    if (ops == 0)
+        return;
+
+    sum = 0;
+    for (i = 0; i < PROF_STAGES; i++) {
+        sum += prof_thr.cyc[i];
+    }
+    for (i = 0; i < PROF_STAGES; i++) {
+        if (prof_thr.calls[i] == 0)
+            continue;
+        fprintf(f, "%s\t%-8s %5.1f x\t%10.3f kcyc\t%5.1f %%\n", label,
+                prof_names[i], (double) prof_thr.calls[i] / (double) ops,
+                1E-3 * (double) prof_thr.cyc[i] / (double) ops,
+                sum > 0 ? 100.0 * prof_thr.cyc[i] / (double) sum : 0.0);
+    }
+#endif
+}
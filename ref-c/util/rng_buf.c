@@ -0,0 +1,67 @@
+//  rng_buf.c
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Buffered front end for random byte generators.
+
+#include <string.h>
+#include "rng_buf.h"
+#include "ct_util.h"
+
+//  Initialize "rb" with source "fill(ctx, ..)" and chunk size "sz".
+
+void rng_buf_init(rng_buf_t *rb, rng_fill_t fill, void *ctx, size_t sz)
+{
+    rb->fill = fill;
+    rb->ctx = ctx;
+    rb->sz = sz < RNG_BUF_SZ ? sz : RNG_BUF_SZ;
+    rb->pos = rb->sz;
+    rb->calls = 0;
+    rb->bytes = 0;
+    memset(rb->buf, 0x00, sizeof(rb->buf));
+}
+
+//  Read "len" random bytes into "out".
+
+int rng_buf_read(rng_buf_t *rb, void *out, size_t len)
+{
+    int ret;
+    size_t n;
+    uint8_t *x = out;
+
+    rb->calls++;
+    rb->bytes += len;
+
+    while (len > 0) {
+
+        if (rb->pos == rb->sz) {
+            //  large requests (all with sz = 0) bypass the buffer
+            if (len >= rb->sz) {
+                return rb->fill(rb->ctx, x, len);
+            }
+            ret = rb->fill(rb->ctx, rb->buf, rb->sz);
+            if (ret != 0) {
+                return ret;
+            }
+            rb->pos = 0;
+        }
+
+        n = rb->sz - rb->pos;
+        if (n > len)
+            n = len;
+        memcpy(x, rb->buf + rb->pos, n);
+        memset(rb->buf + rb->pos, 0x00, n);
+        rb->pos += n;
+        x += n;
+        len -= n;
+    }
+
+    return 0;
+}
+
+//  Discard (and wipe) buffered bytes.
+
+void rng_buf_clear(rng_buf_t *rb)
+{
+    ct_memzero(rb->buf, rb->sz);
+    rb->pos = rb->sz;
+}
@@ -7,6 +7,7 @@
 
 #include "sha3_t.h"
 #include "keccakf1600.h"
+#include "ct_util.h"
 
 //  Initialize the Keccak context "kec" for algorithm-specific rate "r".
 
@@ -59,27 +60,68 @@ void sha3_pad(sha3_t* kec, uint8_t p)
 }
 
 //  Squeeze "h_sz" bytes to address "h" from Keccak context "kec".
+//  Bytes are read from the state lanes directly; whole lanes (and hence
+//  whole blocks) are stored straight into "h" without a staging copy.
 
 void sha3_squeeze(sha3_t* kec, uint8_t* h, size_t h_sz)
 {
-    size_t l;
+    size_t i, l;
 
     while (h_sz > 0) {
         if (kec->i >= kec->r) {
             keccak_f1600(kec->s);
-            keccak_extract(kec->s, kec->b, kec->r);
             kec->i = 0;
         }
-        l = kec->r - kec->i;
-        if (h_sz <= l) {
-            memcpy(h, kec->b + kec->i, h_sz);
-            kec->i += h_sz;
-            return;
-        }
-        memcpy(h, kec->b + kec->i, l);
-        h += l;
-        h_sz -= l;
+        i = kec->i;
+        l = kec->r - i;
+        if (l > h_sz)
+            l = h_sz;
         kec->i += l;
+        h_sz -= l;
+
+        //  unaligned head, whole lanes, tail
+        for (; l > 0 && (i & 7) != 0; l--, i++) {
+            *h++ = (uint8_t)(kec->s[i >> 3] >> (8 * (i & 7)));
+        }
+        for (; l >= 8; l -= 8, i += 8) {
+            put64u_le(h, kec->s[i >> 3]);
+            h += 8;
+        }
+        for (; l > 0; l--, i++) {
+            *h++ = (uint8_t)(kec->s[i >> 3] >> (8 * (i & 7)));
+        }
+    }
+}
+
+//  Squeeze "n" 64-bit words to "w"; w[j] is the little-endian value of the
+//  next 8 output bytes. Lanes are copied in native order when the output
+//  position is lane-aligned (as it is after sha3_pad()).
+
+void sha3_squeeze_words(sha3_t* kec, uint64_t* w, size_t n)
+{
+    size_t l;
+    uint8_t buf[8];
+
+    if ((kec->i & 7) != 0) {
+        for (; n > 0; n--) {
+            sha3_squeeze(kec, buf, 8);
+            *w++ = get64u_le(buf);
+        }
+        return;
+    }
+
+    while (n > 0) {
+        if (kec->i >= kec->r) {
+            keccak_f1600(kec->s);
+            kec->i = 0;
+        }
+        l = (kec->r - kec->i) >> 3;
+        if (l > n)
+            l = n;
+        memcpy(w, &kec->s[kec->i >> 3], 8 * l);
+        w += l;
+        n -= l;
+        kec->i += 8 * l;
     }
 }
 
@@ -87,7 +129,7 @@ void sha3_squeeze(sha3_t* kec, uint8_t* h, size_t h_sz)
 
 void sha3_clear(sha3_t* kec)
 {
-    memset(kec, 0, sizeof(sha3_t));
+    ct_memzero(kec, sizeof(sha3_t));
 }
 
 //  function for single-call sha3
@@ -100,6 +142,7 @@ void sha3_hash(uint8_t* h, size_t h_sz, const uint8_t* m, size_t m_sz)
     sha3_absorb(&kec, m, m_sz);
     sha3_pad(&kec, SHA3_PAD);
     sha3_squeeze(&kec, h, h_sz);
+    sha3_clear(&kec);
 }
 
 //  function for single-call shake at rate r
@@ -113,4 +156,5 @@ void shake_xof( uint8_t* h, size_t h_sz,
     sha3_absorb(&kec, m, m_sz);
     sha3_pad(&kec, SHAKE_PAD);
     sha3_squeeze(&kec, h, h_sz);
+    sha3_clear(&kec);
 }
@@ -0,0 +1,153 @@
+//  sys_random.c
+//  Copyright (c) 2024 Sparrow KEM Team. See LICENSE.
+
+//  === Operating system entropy and a fork-safe SHAKE DRBG for production.
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/random.h>
+#endif
+
+#include "sys_random.h"
+#include "sha3_t.h"
+
+//  Read "len" bytes of OS entropy.
+
+int sys_getrandom(void *ctx, void *buf, size_t len)
+{
+    uint8_t *x = buf;
+    (void) ctx;
+
+#ifdef __linux__
+    ssize_t n;
+
+    while (len > 0) {
+        n = getrandom(x, len, 0);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return -1;
+        }
+        x += n;
+        len -= n;
+    }
+#else
+    size_t n;
+
+    //  getentropy() is limited to 256 bytes per call
+    while (len > 0) {
+        n = len < 256 ? len : 256;
+        if (getentropy(x, n) != 0)
+            return -1;
+        x += n;
+        len -= n;
+    }
+#endif
+    return 0;
+}
+
+//  Seed "drbg" from the OS.
+
+int sys_drbg_init(sys_drbg_t *drbg)
+{
+    drbg->nfill = 0;
+    return sys_getrandom(NULL, drbg->key, sizeof(drbg->key));
+}
+
+//  Output "len" bytes: (key', out) = SHAKE256('D' || key).
+
+int sys_drbg_fill(void *ctx, void *buf, size_t len)
+{
+    sys_drbg_t *drbg = ctx;
+    sha3_t kec;
+    uint8_t d = 'D';
+
+    if (drbg->nfill >= SYS_DRBG_RESEED) {
+        if (sys_drbg_init(drbg) != 0)
+            return -1;
+    }
+    drbg->nfill++;
+
+    sha3_init(&kec, SHAKE256_RATE);
+    sha3_absorb(&kec, &d, 1);
+    sha3_absorb(&kec, drbg->key, sizeof(drbg->key));
+    sha3_pad(&kec, SHAKE_PAD);
+    sha3_squeeze(&kec, drbg->key, sizeof(drbg->key));
+    sha3_squeeze(&kec, buf, len);
+    sha3_clear(&kec);
+
+    return 0;
+}
+
+//  === randombytes() front end
+
+//  Incremented in the child by fork(); a thread whose state was set up in
+//  an earlier generation reseeds, so parent and child never share output.
+//  (A raw clone() system call bypasses pthread_atfork() handlers.)
+
+static uint64_t sys_fork_gen = 1;
+static pthread_once_t sys_fork_once = PTHREAD_ONCE_INIT;
+
+static void sys_fork_child(void)
+{
+    sys_fork_gen++;
+}
+
+static void sys_fork_register(void)
+{
+    pthread_atfork(NULL, NULL, sys_fork_child);
+}
+
+typedef struct {
+    uint64_t gen;                   //  sys_fork_gen when set up; 0 = never
+    sys_drbg_t drbg;
+    rng_buf_t rb;
+} sys_random_t;
+
+static _Thread_local sys_random_t sys_random_tls;
+
+//  set up (or after fork, reset) the calling thread's state
+
+static void sys_random_setup(sys_random_t *sr)
+{
+    pthread_once(&sys_fork_once, sys_fork_register);
+
+#ifdef SPARROW_RNG_SHAKE
+    if (sys_drbg_init(&sr->drbg) != 0)
+        abort();
+    rng_buf_init(&sr->rb, sys_drbg_fill, &sr->drbg, RNG_BUF_SZ);
+#else
+    rng_buf_init(&sr->rb, sys_getrandom, NULL, 0);
+#endif
+    sr->gen = sys_fork_gen;
+}
+
+int sys_randombytes(uint8_t *x, size_t xlen)
+{
+    sys_random_t *sr = &sys_random_tls;
+
+    if (sr->gen != sys_fork_gen) {
+        sys_random_setup(sr);
+    }
+    if (rng_buf_read(&sr->rb, x, xlen) != 0) {
+        abort();
+    }
+    return 0;
+}
+
+//  Front end of sys_randombytes() for the calling thread.
+
+rng_buf_t *sys_random_buf(void)
+{
+    sys_random_t *sr = &sys_random_tls;
+
+    if (sr->gen != sys_fork_gen) {
+        sys_random_setup(sr);
+    }
+    return &sr->rb;
+}
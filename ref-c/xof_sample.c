@@ -13,11 +13,15 @@
 //  Expand "seed" of "seed_sz" bytes to a uniform polynomial (mod q).
 //  The input seed is assumed to alredy contain domain separation.
 
+//  bytes per candidate, and candidates squeezed at a time (whole blocks)
+#define XOF_Q_BYTES ((SPARROW_Q_BITS + 7) / 8)
+#define XOF_Q_BATCH SHAKE256_RATE
+
 void xof_sample_q(int64_t r[SPARROW_N], const uint8_t *seed, size_t seed_sz)
 {
-    size_t i;
+    size_t i, j;
     int64_t x;
-    uint8_t buf[8];
+    uint8_t buf[XOF_Q_BYTES * XOF_Q_BATCH + 8];
     sha3_t kec;
 
     //  sample from squeezed output
@@ -26,10 +30,15 @@ void xof_sample_q(int64_t r[SPARROW_N], const uint8_t *seed, size_t seed_sz)
     sha3_pad(&kec, SHAKE_PAD);
 
     memset(buf, 0, sizeof(buf));
+    j = XOF_Q_BATCH;
     for (i = 0; i < SPARROW_N; i++) {
         do {
-            sha3_squeeze(&kec, buf, (SPARROW_Q_BITS + 7) / 8);
-            x = get64u_le(buf) & SPARROW_QMSK;
+            if (j == XOF_Q_BATCH) {
+                sha3_squeeze(&kec, buf, XOF_Q_BYTES * XOF_Q_BATCH);
+                j = 0;
+            }
+            x = get64u_le(buf + XOF_Q_BYTES * j) & SPARROW_QMSK;
+            j++;
         } while (x >= SPARROW_Q);
         r[i] = x;
     }